@@ -0,0 +1,165 @@
+#ifndef ANYTIME_SQUAD_OPTIMIZER_H
+#define ANYTIME_SQUAD_OPTIMIZER_H
+
+#include "PlayerTable.h"
+#include "Requirements.h"
+#include "SearchProfile.h"
+#include "SquadSearch.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+  Anytime weighted A*. Nodes are expanded in order of g + weight * h, which reaches a first valid squad much
+  sooner than plain A*, and the search then keeps going with the same open set. Every valid squad cheaper
+  than the current best replaces it, and nodes whose g + h is not below the best cost are dropped since they
+  cannot lead to anything cheaper.
+
+  The search stops when the open set runs out (the best squad is then optimal) or when the time or node
+  limit is hit. Because h never overestimates, the smallest g + h left in the open set is a lower bound on
+  the cost of any valid squad, so every result comes with how far from optimal it can be at most.
+*/
+struct AnytimeResult {
+    std::vector<int> squad;     // Best valid squad found, empty if none was found
+    int cost = -1;              // Its total value, -1 if none was found
+    int lowerBound = 0;         // No valid squad costs less than this (INT_MAX if none can exist)
+    bool optimal = false;       // True once the search has proved squad is the cheapest
+    bool exhausted = false;     // True if the whole space was searched (no squad exists if squad is empty)
+    long long nodesExpanded = 0;
+    double seconds = 0;
+
+    // Largest possible relative distance from the optimal cost, 0 when optimal
+    double Gap() const {
+        if (cost <= 0) return cost == 0 ? 0 : 1;
+        return static_cast<double>(cost - std::min(lowerBound, cost)) / cost;
+    }
+};
+
+struct AnytimeOptions {
+    double timeLimitSeconds = 0; // 0 means no time limit
+    long long nodeLimit = 0;     // Nodes expanded before giving up, 0 means no limit
+    double weight = 2.0;         // Weight on h; 1 is plain A*, larger finds a first squad sooner
+
+    // Called with every new best squad, Ex: to print progress while the search continues
+    std::function<void(const AnytimeResult&)> onImprove;
+};
+
+// Entry in the anytime open set: ordered by the weighted key, with the unweighted f kept for pruning and the bound
+struct AnytimeEntry {
+    double key;
+    int estimatedTotalCost;
+    int positionIndex;
+    const SquadNode* node;
+
+    // For a min-heap via std::push_heap with this as "less"; deeper nodes first on equal keys
+    bool operator<(const AnytimeEntry& other) const {
+        if (key != other.key) return key > other.key;
+        return positionIndex < other.positionIndex;
+    }
+};
+
+inline AnytimeResult AnytimeSquadOptimizer(
+    const Formation& formation,
+    const PlayerTable& table,
+    const PlayerByPosition& playerByPosition,
+    const SquadRequirements& req,
+    const AnytimeOptions& options,
+    SearchStats* stats = nullptr
+) {
+    PROFILE_SCOPE(stats ? &stats->profile : nullptr);
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    auto elapsed = [&]() { return std::chrono::duration<double>(Clock::now() - start).count(); };
+
+    AnytimeResult result;
+    SquadSearchContext search(formation, table, playerByPosition, req);
+    ExpansionScratch scratch = search.MakeScratch();
+    std::vector<OpenEntry> children;
+    std::vector<int> squad;
+    NodeArena arena;
+    TranspositionTable expanded(formation);
+    std::vector<AnytimeEntry> open; // Heap ordered by AnytimeEntry::operator<
+
+    double weight = std::max(1.0, options.weight);
+    auto push = [&](const OpenEntry& entry) {
+        int g = entry.node->costSoFar;
+        open.push_back({g + weight * (entry.estimatedTotalCost - g), entry.estimatedTotalCost, entry.positionIndex, entry.node});
+        std::push_heap(open.begin(), open.end());
+    };
+
+    // Smallest f among the open nodes that could still beat the best squad
+    int bestCost = INT_MAX;
+    auto lowerBound = [&]() {
+        int bound = bestCost;
+        for (const AnytimeEntry& entry : open) bound = std::min(bound, entry.estimatedTotalCost);
+        return bound;
+    };
+
+    SquadNode* startNode = search.MakeStart(arena);
+    if (startNode) push({startNode->estimatedTotalCost, startNode->positionIndex, startNode});
+
+    bool stopped = false;
+    long long pops = 0;
+    while (!open.empty()) {
+        // The clock is only read every 256 pops
+        if ((options.nodeLimit > 0 && result.nodesExpanded >= options.nodeLimit) ||
+            (options.timeLimitSeconds > 0 && (pops++ & 255) == 0 && elapsed() >= options.timeLimitSeconds)) {
+            stopped = true;
+            break;
+        }
+
+        std::pop_heap(open.begin(), open.end());
+        AnytimeEntry entry = open.back();
+        open.pop_back();
+        if (entry.estimatedTotalCost >= bestCost) { // Cannot beat the best squad any more
+            PROFILE_COUNT(PRUNE_INCUMBENT);
+            continue;
+        }
+        result.nodesExpanded++;
+        if (stats) {
+            stats->nodesExpanded++;
+            stats->peakOpenSize = std::max(stats->peakOpenSize, open.size() + 1);
+        }
+
+        const SquadNode& current = *entry.node;
+        if (search.IsComplete(current)) {
+            if (search.IsValidSquad(current, squad)) {
+                bestCost = current.costSoFar;
+                result.squad = squad;
+                result.cost = bestCost;
+                if (options.onImprove) {
+                    result.lowerBound = lowerBound();
+                    result.seconds = elapsed();
+                    options.onImprove(result);
+                }
+            }
+            continue;
+        }
+
+        if (!expanded.Insert(&current)) {
+            if (stats) stats->transpositions++;
+            continue;
+        }
+        children.clear();
+        search.Expand(current, arena, scratch, children);
+        for (const OpenEntry& child : children) {
+            if (child.estimatedTotalCost < bestCost) {
+                push(child);
+                if (stats) stats->nodesGenerated++;
+            } else {
+                PROFILE_COUNT(PRUNE_INCUMBENT);
+            }
+        }
+    }
+
+    result.exhausted = !stopped;
+    result.lowerBound = stopped ? lowerBound() : bestCost;
+    result.optimal = !result.squad.empty() && result.lowerBound >= result.cost;
+    result.seconds = elapsed();
+    return result;
+}
+
+#endif // ANYTIME_SQUAD_OPTIMIZER_H
@@ -0,0 +1,201 @@
+#ifndef BATCH_SOLVER_H
+#define BATCH_SOLVER_H
+
+#include "AnytimeSquadOptimizer.h"
+#include "Formations.h"
+#include "IDAStarSquadOptimizer.h"
+#include "LocalSearch.h"
+#include "ParetoFilter.h"
+#include "Player_Organizer.h"
+#include "PlayerTable.h"
+#include "Requirements.h"
+#include "RequirementsIO.h"
+#include "ResultCache.h"
+#include "SquadHelper.h"
+#include "SquadOptimizer.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+  Solves many requirement records against one loaded PlayerOrganizer. Records are read as JSON Lines (see
+  RequirementsIO.h), solved on a ThreadPool and each result is written as one JSON line as soon as it is
+  ready, so the output order follows completion, not input. Every result carries the record's "id" (or
+  its line number) to match it back up.
+
+  The per-position lists only depend on the positions the formation uses and the rating floor, so requests
+  that share both (Ex: "4-4-2" and its alias "4-4-2 Flat") reuse one list built by whichever request needed
+  it first. Solved requests go into a ResultCache, so a repeat (even with another formation alias or quota
+  order) is answered without searching.
+*/
+// The "found", "totalValue", "rating", "chemistry" and "players" fields of a result, without the braces
+inline std::string SquadJSONFields(const Formation& formation, const PlayerTable& table, const std::vector<int>& squad) {
+    std::ostringstream fields;
+    fields << "\"found\": " << (squad.empty() ? "false" : "true");
+    if (squad.empty()) return fields.str();
+    fields << ", \"totalValue\": " << calculateTotalSquadValue(squad, table)
+           << ", \"rating\": " << calculateAverageRating(squad, table)
+           << ", \"chemistry\": " << calculateChem(squad, table) << ", \"players\": [";
+    for (size_t i = 0; i < squad.size(); i++) {
+        int p = squad[i];
+        fields << (i ? ", " : "") << "{\"position\": \"" << PositionName(formation[i]) << "\", \"name\": \""
+               << jsonEscape(table.GetName(p)) << "\", \"rating\": " << table.ratings[p]
+               << ", \"value\": " << table.values[p] << "}";
+    }
+    fields << "]";
+    return fields.str();
+}
+
+class BatchSolver {
+private:
+    const PlayerOrganizer& organizer;
+    const PlayerTable& table;
+    bool useAStar;
+    bool useAnytime = false;
+    bool useLowMemory = false;
+    AnytimeOptions anytime;
+    bool useLocalSearch = false;
+    LocalSearchOptions localSearch;
+    ThreadPool pool;
+    ResultCache results;
+
+    std::mutex cacheMutex;
+    // (FormationPositionMask, minOverallRating) -> lists
+    std::map<std::pair<uint32_t, int>, std::shared_future<std::shared_ptr<const PlayerByPosition>>> listCache;
+
+    std::mutex outputMutex;
+    std::ostream& out;
+
+    std::shared_ptr<const PlayerByPosition> positionLists(const Formation& formation, const SquadRequirements& req) {
+        std::pair<uint32_t, int> key(FormationPositionMask(formation), req.minOverallRating);
+        std::promise<std::shared_ptr<const PlayerByPosition>> promise;
+        std::shared_future<std::shared_ptr<const PlayerByPosition>> future;
+        bool build = false;
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            auto it = listCache.find(key);
+            if (it != listCache.end()) {
+                future = it->second;
+            } else {
+                future = promise.get_future().share();
+                listCache.emplace(key, future);
+                build = true;
+            }
+        }
+        // Built outside the lock; other requests with the same key wait on the future
+        if (build) {
+            promise.set_value(std::make_shared<const PlayerByPosition>(
+                BuildPlayerByPosition(organizer, formation, req.minOverallRating)));
+        }
+        return future.get();
+    }
+
+    void write(const std::string& line) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        out << line << "\n";
+        out.flush();
+    }
+
+    void solve(const std::string& id, const SquadRequirements& req) {
+        auto start = std::chrono::steady_clock::now();
+        const Formation& formation = *FindFormation(req.formation); // Checked by ParseRequirementsJSON
+        std::string label = SolverLabel(useAStar, useLocalSearch, localSearch);
+        std::vector<int> squad;
+        AnytimeResult bounded;
+        SearchStats stats;
+        bool cached = results.Get(label, req, squad);
+        if (cached) {
+            bounded.exhausted = true; // Anytime runs are only cached once proved optimal
+        } else {
+            PlayerByPosition playerByPosition = *positionLists(formation, req);
+            ParetoFilterPositions(playerByPosition, formation, table, req); // Depends on the quotas, so done per request
+            if (useAStar && useAnytime) {
+                bounded = AnytimeSquadOptimizer(formation, table, playerByPosition, req, anytime, &stats);
+                squad = bounded.squad;
+            } else if (useAStar && useLowMemory) {
+                squad = IDAStarSquadOptimizer(formation, table, playerByPosition, req, &stats);
+            } else if (useAStar) {
+                squad = AStarSquadOptimizer(formation, table, playerByPosition, req, &stats);
+            } else {
+                squad = BestFitSquadOptimizer(formation, table, playerByPosition, req, &stats);
+                if (useLocalSearch) squad = ImproveSquad(formation, table, playerByPosition, req, squad, localSearch);
+            }
+            if (!(useAStar && useAnytime) || bounded.exhausted || bounded.optimal) results.Put(label, req, squad);
+        }
+        std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+
+        std::ostringstream result;
+        result << "{\"id\": \"" << jsonEscape(id) << "\", \"algorithm\": \"" << (useAStar ? "astar" : "bestfit")
+               << "\", " << SquadJSONFields(formation, table, squad);
+        if (useAStar && useAnytime) {
+            result << ", \"optimal\": " << (bounded.optimal || bounded.exhausted ? "true" : "false");
+            if (!bounded.exhausted) result << ", \"lowerBound\": " << bounded.lowerBound;
+        }
+        if (cached) result << ", \"cached\": true";
+#ifdef SQUAD_PROFILE
+        else result << ", \"stats\": " << stats.ToJSON();
+#endif
+        result << ", \"ms\": " << duration.count() << "}";
+        write(result.str());
+    }
+
+public:
+    // threadCount = 0 uses one worker per hardware core. cachePath names a file that keeps solved requests
+    // between runs, empty keeps them in memory only.
+    BatchSolver(const PlayerOrganizer& organizer, bool useAStar, unsigned threadCount, std::ostream& out,
+                const std::string& cachePath = "")
+        : organizer(organizer), table(organizer.GetAllPlayers()), useAStar(useAStar), pool(threadCount),
+          results(table, 4096, cachePath), out(out) {}
+
+    // Gives every A* request a time or node budget; each then reports the best squad found and its bound
+    void SetAnytime(const AnytimeOptions& options) {
+        anytime = options;
+        anytime.onImprove = nullptr;
+        useAnytime = true;
+    }
+
+    // Solves A* requests with IDA*, whose memory stays fixed instead of growing with the open set
+    void SetLowMemory() { useLowMemory = true; }
+
+    // Runs simulated annealing on every Best Fit squad. The restarts of one request stay on the worker
+    // thread solving it, since the other workers already keep the cores busy.
+    void SetLocalSearch(const LocalSearchOptions& options) {
+        localSearch = options;
+        localSearch.threads = 1;
+        useLocalSearch = true;
+    }
+
+    // Reads records from in until it ends, queueing each one as soon as it is read. Returns the number of
+    // records that could not be parsed; those get an error line instead of a result.
+    int Run(std::istream& in) {
+        int failed = 0;
+        int lineNumber = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            lineNumber++;
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+            SquadRequirements req;
+            std::string id, error;
+            if (!ParseRequirementsJSON(line, req, id, error)) {
+                failed++;
+                write("{\"line\": " + std::to_string(lineNumber) + ", \"error\": \"" + jsonEscape(error) + "\"}");
+                continue;
+            }
+            if (id.empty()) id = std::to_string(lineNumber);
+            pool.Submit([this, id, req]() { solve(id, req); });
+        }
+        pool.Wait();
+        return failed;
+    }
+};
+
+#endif // BATCH_SOLVER_H
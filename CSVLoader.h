@@ -0,0 +1,366 @@
+#ifndef CSV_LOADER_H
+#define CSV_LOADER_H
+
+#include "Formations.h"
+#include "MappedFile.h"
+#include "PlayerTable.h"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//Helper which splits each line of the CSV file respecting fields with quotes
+inline std::vector<std::string> parseCSVLine(const std::string& line){
+    std::vector<std::string> cells;
+    std::string cell;
+    bool inQuotes = false;
+
+    for(size_t i = 0; i<line.size(); i++){
+        char c = line[i];
+        if(c == '"'){
+            inQuotes = !inQuotes;
+        } else if (c==',' && !inQuotes){
+            cells.push_back(cell);
+            cell.clear();
+        }else{
+            cell += c;
+        }
+    }
+    cells.push_back(cell);
+    return cells;
+}
+
+// The columns of male_players.csv that the loader keeps
+enum CSVField {
+    FIELD_SHORT_NAME,
+    FIELD_POSITIONS,
+    FIELD_OVERALL,
+    FIELD_VALUE,
+    FIELD_NATION,
+    FIELD_LEAGUE,
+    FIELD_CLUB,
+    FIELD_PLAYER_ID, // The fields from here on are optional
+    FIELD_VERSION,
+    FIELD_UPDATE,
+    FIELD_COUNT
+};
+
+// Fields before this one are required and, like the original loader, read column 0 when missing
+static constexpr int kFirstOptionalField = FIELD_PLAYER_ID;
+
+// Location of one cell inside the mapped file. Quote characters are still in the range and are only
+// stripped when the cell is copied out, which matches what parseCSVLine does.
+struct CSVCellRef {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    bool hasQuotes = false;
+};
+
+// Copies a cell into a reusable buffer, dropping quote characters the same way parseCSVLine does
+inline void copyCell(const CSVCellRef& cell, std::string& out) {
+    if (!cell.hasQuotes) {
+        out.assign(cell.begin, cell.end);
+        return;
+    }
+    out.clear();
+    for (const char* c = cell.begin; c != cell.end; ++c) {
+        if (*c != '"') out += *c;
+    }
+}
+
+// Parses an integer with the same rules as std::stoi: leading whitespace, an optional sign and at least one digit.
+// Returns false where std::stoi would throw.
+inline bool parseIntLikeStoi(const std::string& str, int& out) {
+    size_t i = 0;
+    while (i < str.size() && std::isspace(static_cast<unsigned char>(str[i]))) i++;
+
+    bool negative = false;
+    if (i < str.size() && (str[i] == '+' || str[i] == '-')) {
+        negative = str[i] == '-';
+        i++;
+    }
+
+    long long result = 0;
+    size_t digits = 0;
+    for (; i < str.size() && str[i] >= '0' && str[i] <= '9'; i++, digits++) {
+        result = result * 10 + (str[i] - '0');
+        if (result > static_cast<long long>(INT_MAX) + 1) return false;
+    }
+    if (digits == 0) return false;
+
+    if (negative) result = -result;
+    if (result > INT_MAX || result < INT_MIN) return false;
+    out = static_cast<int>(result);
+    return true;
+}
+
+// Rows a load may skip because no request will use them: rows below the rating floor, and rows that play
+// none of the positions asked for. The default filter keeps every row. Quota nations, leagues and clubs are
+// not filtered on, since a quota is only a minimum and the rest of the squad can come from anywhere.
+struct LoadFilter {
+    int minRating = INT_MIN;
+    uint32_t positionMask = 0; // PositionBit of every position wanted, 0 keeps every position
+
+    // Widens the filter so it also keeps every row a request for formation with this rating floor can use
+    void Include(const Formation& formation, int minOverallRating) {
+        minRating = positionMask == 0 ? minOverallRating : std::min(minRating, minOverallRating);
+        positionMask |= FormationPositionMask(formation);
+    }
+
+    bool KeepsAll() const { return minRating == INT_MIN && positionMask == 0; }
+    bool KeepsRating(int rating) const { return rating >= minRating; }
+    bool KeepsPositions(uint32_t mask) const { return positionMask == 0 || (mask & positionMask) != 0; }
+};
+
+// Drops the rows filter does not keep, in place and in row order. The string pools are kept as they are.
+inline void ApplyLoadFilter(PlayerTable& table, const LoadFilter& filter) {
+    if (filter.KeepsAll()) return;
+
+    PlayerTable kept;
+    kept.names = std::move(table.names);
+    kept.nations = std::move(table.nations);
+    kept.leagues = std::move(table.leagues);
+    kept.clubs = std::move(table.clubs);
+    kept.positions = std::move(table.positions);
+    for (size_t row = 0; row < table.Size(); row++) {
+        if (!filter.KeepsRating(table.ratings[row]) || !filter.KeepsPositions(table.positionMasks[row])) continue;
+        kept.AddRow(table.nameIds[row], table.ratings[row], table.values[row], table.nationIds[row], table.leagueIds[row],
+                    table.clubIds[row], table.positionMasks[row], table.playerIds[row], table.versions[row]);
+    }
+    table = std::move(kept);
+}
+
+// Per-thread parsing state. Every chunk interns into its own PlayerTable so no locking is needed, and the
+// scratch strings keep their capacity between rows so cells are not allocated one by one.
+struct CSVChunkParser {
+    const std::vector<int>& fieldOfColumn; // Column index -> CSVField, or -1 for columns we skip
+    size_t headerCount;
+    const LoadFilter& filter;
+    PlayerTable table;
+    std::string scratch;
+    std::string token;
+
+    CSVChunkParser(const std::vector<int>& fieldOfColumn, size_t headerCount, const LoadFilter& filter)
+        : fieldOfColumn(fieldOfColumn), headerCount(headerCount), filter(filter) {}
+
+    // Splits the position field (Ex: "ST, LW") and interns each entry, trimming spaces and tabs
+    uint32_t internPositions(const std::string& str) {
+        uint32_t mask = 0;
+        size_t start = 0;
+        while (start < str.size()) {
+            size_t comma = str.find(',', start);
+            size_t stop = comma == std::string::npos ? str.size() : comma;
+
+            size_t first = str.find_first_not_of(" \t", start);
+            if (first == std::string::npos || first >= stop) {
+                token.clear();
+            } else {
+                size_t last = str.find_last_not_of(" \t", stop - 1);
+                token.assign(str, first, last - first + 1);
+            }
+
+            int posId = table.positions.Intern(token);
+            if (posId < PlayerTable::kMaxPositions) mask |= (1u << posId);
+
+            if (comma == std::string::npos) break;
+            start = comma + 1;
+        }
+        return mask;
+    }
+
+    void parseLine(const char* begin, const char* end) {
+        CSVCellRef cells[FIELD_COUNT];
+        size_t cellCount = 0;
+        bool inQuotes = false;
+        CSVCellRef current;
+        current.begin = begin;
+
+        for (const char* c = begin; c != end; ++c) {
+            if (*c == '"') {
+                inQuotes = !inQuotes;
+                current.hasQuotes = true;
+            } else if (*c == ',' && !inQuotes) {
+                current.end = c;
+                if (cellCount < fieldOfColumn.size() && fieldOfColumn[cellCount] >= 0) cells[fieldOfColumn[cellCount]] = current;
+                cellCount++;
+                current = CSVCellRef();
+                current.begin = c + 1;
+            }
+        }
+        current.end = end;
+        if (cellCount < fieldOfColumn.size() && fieldOfColumn[cellCount] >= 0) cells[fieldOfColumn[cellCount]] = current;
+        cellCount++;
+
+        if (cellCount < headerCount) return; //skips any bad rows just in case
+
+        int rating = 0;
+        copyCell(cells[FIELD_OVERALL], scratch);
+        if (!scratch.empty() && !parseIntLikeStoi(scratch, rating)) return; //Skips bad rows
+        if (!filter.KeepsRating(rating)) return; //Filtered rows are dropped before any of their strings are interned
+
+        int value = 0;
+        copyCell(cells[FIELD_VALUE], scratch);
+        if (!scratch.empty() && !parseIntLikeStoi(scratch, value)) return;
+        value = value/500;
+
+        copyCell(cells[FIELD_POSITIONS], scratch);
+        uint32_t mask = internPositions(scratch); // Position names are interned first, so the bits match PositionBit
+        if (!filter.KeepsPositions(mask)) return;
+
+        // Identity and version columns; a missing or unreadable one just means no identity/version
+        int playerId = -1;
+        copyCell(cells[FIELD_PLAYER_ID], scratch);
+        if (!parseIntLikeStoi(scratch, playerId) || playerId < 0) playerId = -1;
+        int fifaVersion = 0, fifaUpdate = 0;
+        copyCell(cells[FIELD_VERSION], scratch);
+        if (!parseIntLikeStoi(scratch, fifaVersion)) fifaVersion = 0;
+        copyCell(cells[FIELD_UPDATE], scratch);
+        if (!parseIntLikeStoi(scratch, fifaUpdate)) fifaUpdate = 0;
+        int version = fifaVersion * 1000 + fifaUpdate;
+
+        copyCell(cells[FIELD_SHORT_NAME], scratch);
+        int nameId = table.names.Intern(scratch);
+        copyCell(cells[FIELD_NATION], scratch);
+        int nationId = table.nations.Intern(scratch);
+        copyCell(cells[FIELD_LEAGUE], scratch);
+        int leagueId = table.leagues.Intern(scratch);
+        copyCell(cells[FIELD_CLUB], scratch);
+        int clubId = table.clubs.Intern(scratch);
+
+        table.AddRow(nameId, rating, value, nationId, leagueId, clubId, mask, playerId, version);
+    }
+
+    // Parses every line in [begin, end). Lines end at '\n' exactly like std::getline.
+    void parseRange(const char* begin, const char* end) {
+        const char* lineStart = begin;
+        while (lineStart < end) {
+            const char* lineEnd = static_cast<const char*>(memchr(lineStart, '\n', end - lineStart));
+            if (!lineEnd) lineEnd = end;
+            parseLine(lineStart, lineEnd);
+            lineStart = lineEnd + 1;
+        }
+    }
+};
+
+// Appends the rows parsed by one chunk to the shared table, translating its local string ids into the
+// shared pools. Chunks are merged in file order, so row order and id assignment match a sequential load.
+inline void mergeChunk(const PlayerTable& chunk, PlayerTable& table) {
+    auto remap = [](const StringPool& from, StringPool& to) {
+        std::vector<int> ids(from.Size());
+        for (size_t id = 0; id < from.Size(); id++) ids[id] = to.Intern(from.Get(static_cast<int>(id)));
+        return ids;
+    };
+    std::vector<int> nameIds = remap(chunk.names, table.names);
+    std::vector<int> nationIds = remap(chunk.nations, table.nations);
+    std::vector<int> leagueIds = remap(chunk.leagues, table.leagues);
+    std::vector<int> clubIds = remap(chunk.clubs, table.clubs);
+    std::vector<int> positionIds = remap(chunk.positions, table.positions);
+
+    for (size_t row = 0; row < chunk.Size(); row++) {
+        uint32_t mask = 0;
+        for (size_t posId = 0; posId < positionIds.size() && posId < PlayerTable::kMaxPositions; posId++) {
+            if ((chunk.positionMasks[row] & (1u << posId)) && positionIds[posId] < PlayerTable::kMaxPositions) {
+                mask |= (1u << positionIds[posId]);
+            }
+        }
+        table.AddRow(nameIds[chunk.nameIds[row]], chunk.ratings[row], chunk.values[row],
+                     nationIds[chunk.nationIds[row]], leagueIds[chunk.leagueIds[row]], clubIds[chunk.clubIds[row]], mask,
+                     chunk.playerIds[row], chunk.versions[row]);
+    }
+}
+
+// Loads male_players.csv into the table. The file is memory mapped, split into newline-aligned chunks and
+// the chunks are parsed in parallel. threadCount = 0 uses one thread per hardware core. Rows filter does not
+// keep are skipped while parsing, so the table and its string pools only ever hold the rows that are kept.
+inline bool LoadPlayersCSV(const std::string& filename, PlayerTable& table, unsigned threadCount = 0,
+                           const LoadFilter& filter = LoadFilter()) {
+    MappedFile file;
+    if (!file.Open(filename)) {
+        std::cerr <<"Error opening file. \n";
+        return false;
+    }
+
+    const char* data = file.Data();
+    const char* dataEnd = data + file.Size();
+
+    //Header: includes all column names
+    const char* headerEnd = static_cast<const char*>(memchr(data, '\n', file.Size()));
+    if (!headerEnd) headerEnd = dataEnd;
+    std::vector<std::string> headers = parseCSVLine(std::string(data, headerEnd));
+
+    //Maps column names to an index. Like columnIndex[...] in the old loader, a missing column reads column 0.
+    std::unordered_map<std::string, int> columnIndex;
+    for (size_t i = 0; i < headers.size(); i++) {
+        columnIndex[headers[i]] = static_cast<int>(i);
+    }
+    const char* fieldNames[FIELD_COUNT] = {"short_name", "player_positions", "overall", "value_eur",
+                                           "nationality_name", "league_name", "club_name",
+                                           "player_id", "fifa_version", "fifa_update"};
+    std::vector<std::vector<int>> fieldsOfColumn(headers.size());
+    for (int field = 0; field < FIELD_COUNT; field++) {
+        if (field >= kFirstOptionalField && !columnIndex.count(fieldNames[field])) continue;
+        fieldsOfColumn[columnIndex[fieldNames[field]]].push_back(field);
+    }
+
+    // A column can only feed one field in the single-pass parser; that only matters for malformed headers
+    std::vector<int> fieldOfColumn(headers.size(), -1);
+    for (size_t col = 0; col < headers.size(); col++) {
+        if (fieldsOfColumn[col].size() == 1) fieldOfColumn[col] = fieldsOfColumn[col][0];
+        else if (fieldsOfColumn[col].size() > 1) {
+            std::cerr << "Error: column " << headers[col] << " is used for more than one field. \n";
+            return false;
+        }
+    }
+
+    const char* body = headerEnd < dataEnd ? headerEnd + 1 : dataEnd;
+    size_t bodySize = dataEnd - body;
+
+    // Split into chunks that each start at the beginning of a line. Small files are not worth the threads.
+    const size_t minChunkSize = 1 << 20;
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount, bodySize / minChunkSize));
+
+    std::vector<const char*> bounds;
+    bounds.push_back(body);
+    for (size_t i = 1; i < chunkCount; i++) {
+        const char* split = body + bodySize * i / chunkCount;
+        if (split < bounds.back()) split = bounds.back();
+        const char* newline = static_cast<const char*>(memchr(split, '\n', dataEnd - split));
+        bounds.push_back(newline ? newline + 1 : dataEnd);
+    }
+    bounds.push_back(dataEnd);
+
+    std::vector<CSVChunkParser> parsers;
+    parsers.reserve(chunkCount);
+    for (size_t i = 0; i < chunkCount; i++) parsers.emplace_back(fieldOfColumn, headers.size(), filter);
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < chunkCount; i++) {
+        workers.emplace_back([&parsers, &bounds, i]() { parsers[i].parseRange(bounds[i], bounds[i + 1]); });
+    }
+    parsers[0].parseRange(bounds[0], bounds[1]);
+    for (std::thread& worker : workers) worker.join();
+
+    size_t totalRows = table.Size();
+    for (const CSVChunkParser& parser : parsers) totalRows += parser.table.Size();
+    table.nameIds.reserve(totalRows);
+    table.ratings.reserve(totalRows);
+    table.values.reserve(totalRows);
+    table.nationIds.reserve(totalRows);
+    table.leagueIds.reserve(totalRows);
+    table.clubIds.reserve(totalRows);
+    table.positionMasks.reserve(totalRows);
+    table.playerIds.reserve(totalRows);
+    table.versions.reserve(totalRows);
+    table.identityIds.reserve(totalRows);
+
+    for (const CSVChunkParser& parser : parsers) mergeChunk(parser.table, table);
+    return true;
+}
+
+#endif // CSV_LOADER_H
@@ -0,0 +1,149 @@
+#ifndef CANDIDATE_RANKER_H
+#define CANDIDATE_RANKER_H
+
+#include "ChemLinkKernel.h"
+#include "Formations.h"
+#include "Player_Organizer.h"
+#include "PlayerTable.h"
+#include "SearchProfile.h"
+#include "SquadHelper.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Candidates are scored by their rating-value ratio plus a weighted estimate of the chemistry boost they
+// would give the squad. The weight keeps the algorithms from heavily favoring chemistry over value.
+inline double ratingValueScore(int player, const PlayerTable& table) {
+    int value = table.values[player];
+    return value > 0 ? (double)table.ratings[player] / value : table.ratings[player];
+}
+
+// Estimates the potential chemistry boost a player would have to a squad: one point for every member
+// sharing their nation, club or league
+inline int estChemBoost(int player, const ChemistryState& squad, const PlayerTable& table) {
+    return squad.LinkCount(player, table);
+}
+
+// A position's candidates in their static base order: best rating-value ratio first. The club, nation and
+// league ids are copied next to them so CountChemLinks can score the whole pool in one pass.
+struct RankedPool {
+    std::vector<int> rows;
+    std::vector<double> baseScores;
+    std::vector<int> clubIds, nationIds, leagueIds;
+};
+
+// Streams the candidates of one pool best-first for the current squad. The base order is fixed, and a
+// candidate's chemistry boost is at most weight * squad.MaxLinkCount(), so once the best candidate seen so far
+// beats the next base score plus that bound it is final. Only as many candidates as are taken get scored,
+// unless the caller will take all of them anyway (A* expansions); then the chemistry links of the whole pool
+// are counted up front with CountChemLinks, which gives the same scores and therefore the same order.
+class RankedCandidates {
+private:
+    struct Entry {
+        double score;
+        int baseIndex;
+
+        // Max-heap on score; equal scores come out in base order
+        bool operator<(const Entry& other) const {
+            if (score != other.score) return score < other.score;
+            return baseIndex > other.baseIndex;
+        }
+    };
+
+    const RankedPool* pool = nullptr;
+    const ChemistryState* squad = nullptr;
+    const PlayerTable* table = nullptr;
+    double weight = 0;
+    double boostBound = 0;
+    size_t cursor = 0;
+    std::vector<Entry> heap;
+    bool wholePool = false;
+    std::vector<int> links; // [base index] chemistry links, filled in by Reset when wholePool is set
+
+public:
+    void Reset(const RankedPool& rankedPool, const ChemistryState& squadState, const PlayerTable& players, double chemWeight,
+               bool scoreWholePool = false) {
+        pool = &rankedPool;
+        squad = &squadState;
+        table = &players;
+        weight = chemWeight;
+        boostBound = chemWeight * squadState.MaxLinkCount();
+        cursor = 0;
+        heap.clear(); // Keeps its capacity between expansions
+        wholePool = scoreWholePool;
+        if (wholePool) {
+            PROFILE_TIME(TIME_CANDIDATES);
+            links.resize(rankedPool.rows.size());
+            CountChemLinks(rankedPool.clubIds.data(), rankedPool.nationIds.data(), rankedPool.leagueIds.data(),
+                           static_cast<int>(rankedPool.rows.size()), squadState, links.data());
+        }
+    }
+
+    // Writes the next best candidate to row. Returns false once every candidate has been produced.
+    bool Next(int& row) {
+        PROFILE_TIME(TIME_CANDIDATES);
+        while (cursor < pool->rows.size() &&
+               (heap.empty() || heap.front().score < pool->baseScores[cursor] + boostBound)) {
+            int boost = wholePool ? links[cursor] : estChemBoost(pool->rows[cursor], *squad, *table);
+            double score = pool->baseScores[cursor] + weight * boost;
+            heap.push_back({score, static_cast<int>(cursor)});
+            std::push_heap(heap.begin(), heap.end());
+            cursor++;
+        }
+        if (heap.empty()) return false;
+
+        std::pop_heap(heap.begin(), heap.end());
+        row = pool->rows[heap.back().baseIndex];
+        heap.pop_back();
+        return true;
+    }
+};
+
+// Base orders for every position of a formation, computed once per search
+class CandidateRanker {
+private:
+    std::vector<RankedPool> pools;
+    std::vector<int> poolOfSlot; // Formation slot -> index into pools, or -1 if nobody plays it
+
+public:
+    CandidateRanker(const Formation& formation, const PlayerTable& table, const PlayerByPosition& playerByPosition) {
+        PROFILE_TIME(TIME_CANDIDATES);
+        int poolOfPosition[POSITION_COUNT];
+        std::fill(poolOfPosition, poolOfPosition + POSITION_COUNT, -1);
+        for (Position pos : formation) {
+            if (poolOfPosition[pos] >= 0 || playerByPosition[pos].empty()) {
+                poolOfSlot.push_back(poolOfPosition[pos]);
+                continue;
+            }
+
+            RankedPool pool;
+            pool.rows = playerByPosition[pos];
+            std::stable_sort(pool.rows.begin(), pool.rows.end(), [&](int a, int b) {
+                return ratingValueScore(a, table) > ratingValueScore(b, table);
+            });
+            pool.baseScores.reserve(pool.rows.size());
+            for (int row : pool.rows) {
+                pool.baseScores.push_back(ratingValueScore(row, table));
+                pool.clubIds.push_back(table.clubIds[row]);
+                pool.nationIds.push_back(table.nationIds[row]);
+                pool.leagueIds.push_back(table.leagueIds[row]);
+            }
+
+            poolOfPosition[pos] = static_cast<int>(pools.size());
+            poolOfSlot.push_back(static_cast<int>(pools.size()));
+            pools.push_back(std::move(pool));
+        }
+    }
+
+    bool HasCandidates(int slot) const { return poolOfSlot[slot] >= 0; }
+    const RankedPool& Pool(int slot) const { return pools[poolOfSlot[slot]]; }
+
+    // Starts streaming the candidates for slot against the given squad. Set scoreWholePool when every
+    // candidate will be taken, so their chemistry is counted in one vectorized pass.
+    void Rank(int slot, const ChemistryState& squad, const PlayerTable& table, double chemWeight, RankedCandidates& out,
+              bool scoreWholePool = false) const {
+        out.Reset(pools[poolOfSlot[slot]], squad, table, chemWeight, scoreWholePool);
+    }
+};
+
+#endif // CANDIDATE_RANKER_H
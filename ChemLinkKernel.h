@@ -0,0 +1,107 @@
+#ifndef CHEM_LINK_KERNEL_H
+#define CHEM_LINK_KERNEL_H
+
+#include "SquadHelper.h"
+
+#if !defined(SQUAD_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#define CHEM_LINK_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+  Counts the chemistry links (estChemBoost) of a whole position pool against a squad in one pass.
+
+  The pool keeps the club, nation and league ids of its candidates in their own arrays, so a block of
+  candidates can be compared against one squad group at a time: for each club, nation and league in the squad
+  (at most 11 of each), every candidate with that id gains the number of squad members in it. On x86-64 the
+  blocks are 8 candidates wide with AVX2 when the CPU has it and 4 wide with SSE2 otherwise; other targets, or
+  builds with -DSQUAD_NO_SIMD, use the scalar loop. All of them give exactly squad.LinkCount(row) for every
+  candidate, so the ranking does not depend on which one runs.
+*/
+
+// Squad groups laid out for the vector kernels: the clubs first, then the nations, then the leagues. A
+// candidate whose id in that column equals ids[g] gains counts[g] links.
+struct ChemLinkGroups {
+    int ids[3 * ChemistryState::kMaxPlayers];
+    int counts[3 * ChemistryState::kMaxPlayers];
+    int size[3] = {0, 0, 0}; // Groups per column: clubs, nations, leagues
+
+    explicit ChemLinkGroups(const ChemistryState& squad) {
+        const ChemGroupCounts* columns[3] = {&squad.Clubs(), &squad.Nations(), &squad.Leagues()};
+        int g = 0;
+        for (int c = 0; c < 3; c++) {
+            for (int i = 0; i < columns[c]->size; i++, g++) {
+                ids[g] = columns[c]->ids[i];
+                counts[g] = columns[c]->counts[i];
+            }
+            size[c] = columns[c]->size;
+        }
+    }
+};
+
+inline void countChemLinksScalar(const int* clubIds, const int* nationIds, const int* leagueIds, int begin, int end,
+                                 const ChemistryState& squad, int* links) {
+    for (int i = begin; i < end; i++) {
+        links[i] = squad.Clubs().Count(clubIds[i]) + squad.Nations().Count(nationIds[i]) + squad.Leagues().Count(leagueIds[i]);
+    }
+}
+
+#ifdef CHEM_LINK_X86
+// Returns the number of candidates done; the caller finishes the rest with the scalar loop
+inline int countChemLinksSSE2(const int* const columns[3], int count, const ChemLinkGroups& groups, int* links) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i total = _mm_setzero_si128();
+        for (int c = 0, g = 0; c < 3; c++) {
+            __m128i ids = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columns[c] + i));
+            for (int k = 0; k < groups.size[c]; k++, g++) {
+                __m128i match = _mm_cmpeq_epi32(ids, _mm_set1_epi32(groups.ids[g]));
+                total = _mm_add_epi32(total, _mm_and_si128(match, _mm_set1_epi32(groups.counts[g])));
+            }
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(links + i), total);
+    }
+    return i;
+}
+
+#if defined(__GNUC__)
+__attribute__((target("avx2")))
+inline int countChemLinksAVX2(const int* const columns[3], int count, const ChemLinkGroups& groups, int* links) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i total = _mm256_setzero_si256();
+        for (int c = 0, g = 0; c < 3; c++) {
+            __m256i ids = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns[c] + i));
+            for (int k = 0; k < groups.size[c]; k++, g++) {
+                __m256i match = _mm256_cmpeq_epi32(ids, _mm256_set1_epi32(groups.ids[g]));
+                total = _mm256_add_epi32(total, _mm256_and_si256(match, _mm256_set1_epi32(groups.counts[g])));
+            }
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(links + i), total);
+    }
+    return i;
+}
+
+inline bool cpuHasAVX2() {
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    return hasAVX2;
+}
+#endif
+#endif
+
+// Writes squad.LinkCount of candidate i to links[i] for every i < count, given the candidates' id columns
+inline void CountChemLinks(const int* clubIds, const int* nationIds, const int* leagueIds, int count,
+                           const ChemistryState& squad, int* links) {
+    int done = 0;
+#ifdef CHEM_LINK_X86
+    const int* const columns[3] = {clubIds, nationIds, leagueIds};
+    ChemLinkGroups groups(squad);
+#if defined(__GNUC__)
+    if (cpuHasAVX2()) done = countChemLinksAVX2(columns, count, groups, links);
+#endif
+    if (done == 0) done = countChemLinksSSE2(columns, count, groups, links);
+#endif
+    countChemLinksScalar(clubIds, nationIds, leagueIds, done, count, squad, links);
+}
+
+#endif // CHEM_LINK_KERNEL_H
@@ -1,64 +1,94 @@
 #ifndef FORMATIONS_H
 #define FORMATIONS_H
 
+#include "Positions.h"
+#include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
-#include <unordered_map>
 
-class Formations {
-private:
-    std::unordered_map<std::string, std::vector<std::string>> formationMap;
+constexpr int kSquadSize = 11;
 
-public:
-    Formations() {
-        formationMap = {
-            {"3-1-4-2", {"GK", "CB", "CB", "CB", "CDM", "LM", "CM", "CM", "RM", "ST", "ST"}},
-            {"3-4-1-2", {"GK", "CB", "CB", "CB", "LM", "CM", "CM", "RM", "CAM", "ST", "ST"}},
-            {"3-4-2-1", {"GK", "CB", "CB", "CB", "LM", "CM", "CM", "RM", "LF", "RF", "ST"}},
-            {"3-4-3", {"GK", "CB", "CB", "CB", "LM", "CM", "CM", "RM", "LW", "RW", "ST"}},
-            {"3-5-1-1", {"GK", "CB", "CB", "CB", "CDM", "LM", "CM", "CM", "RM", "CAM", "ST"}},
-            {"3-5-2", {"GK", "CB", "CB", "CB", "CDM", "CDM", "LM", "CAM", "RM", "ST", "ST"}},
+// Positions of the 11 slots of a formation, in the order the optimizers fill them
+using Formation = std::array<Position, kSquadSize>;
 
-            {"4-1-2-1-2", {"GK", "LB", "CB", "CB", "RB", "CDM", "LM", "RM", "CAM", "ST", "ST"}},
-            {"4-1-2-1-2 Wide", {"GK", "LB", "CB", "CB", "RB", "CDM", "LM", "RM", "CAM", "ST", "ST"}},
-            {"4-1-4-1", {"GK", "LB", "CB", "CB", "RB", "CDM", "LM", "CM", "CM", "RM", "ST"}},
-            {"4-2-2-2", {"GK", "LB", "CB", "CB", "RB", "CDM", "CDM", "LAM", "RAM", "ST", "ST"}},
-            {"4-2-3-1", {"GK", "LB", "CB", "CB", "RB", "CDM", "CDM", "CAM", "LM", "RM", "ST"}},
-            {"4-2-3-1 Wide", {"GK", "LB", "CB", "CB", "RB", "CDM", "CDM", "CAM", "LM", "RM", "ST"}},
-            {"4-3-1-2", {"GK", "LB", "CB", "CB", "RB", "CM", "CM", "CM", "CAM", "ST", "ST"}},
-            {"4-3-2-1", {"GK", "LB", "CB", "CB", "RB", "CM", "CM", "CM", "LF", "RF", "ST"}},
-            {"4-3-3", {"GK", "LB", "CB", "CB", "RB", "CM", "CM", "CM", "LW", "RW", "ST"}},
-            {"4-3-3 Attack", {"GK", "LB", "CB", "CB", "RB", "CM", "CAM", "CDM", "LW", "RW", "ST"}},
-            {"4-3-3 Defend", {"GK", "LB", "CB", "CB", "RB", "CDM", "CDM", "CM", "LW", "RW", "ST"}},
-            {"4-3-3 Flat", {"GK", "LB", "CB", "CB", "RB", "CM", "CM", "CM", "LW", "RW", "ST"}},
-            {"4-3-3 False 9", {"GK", "LB", "CB", "CB", "RB", "CM", "CM", "CM", "LW", "RW", "CF"}},
-            {"4-4-1-1", {"GK", "LB", "CB", "CB", "RB", "LM", "CM", "CM", "RM", "CF", "ST"}},
-            {"4-4-2", {"GK", "LB", "CB", "CB", "RB", "LM", "CM", "CM", "RM", "ST", "ST"}},
-            {"4-4-2 Flat", {"GK", "LB", "CB", "CB", "RB", "LM", "CM", "CM", "RM", "ST", "ST"}},
-            {"4-4-2 Holding", {"GK", "LB", "CB", "CB", "RB", "LM", "CDM", "CDM", "RM", "ST", "ST"}},
+struct FormationEntry {
+    const char* name;
+    Formation slots;
+};
 
-            {"5-2-1-2", {"GK", "LWB", "CB", "CB", "CB", "RWB", "CM", "CM", "CAM", "ST", "ST"}},
-            {"5-2-2-1", {"GK", "LWB", "CB", "CB", "CB", "RWB", "CM", "CM", "LF", "RF", "ST"}},
-            {"5-3-2", {"GK", "LWB", "CB", "CB", "CB", "RWB", "CM", "CM", "CM", "ST", "ST"}},
-            {"5-4-1", {"GK", "LWB", "CB", "CB", "CB", "RWB", "LM", "CM", "CM", "RM", "ST"}}
-        };
-    }
+constexpr FormationEntry kFormations[] = {
+    {"3-1-4-2", {POS_GK, POS_CB, POS_CB, POS_CB, POS_CDM, POS_LM, POS_CM, POS_CM, POS_RM, POS_ST, POS_ST}},
+    {"3-4-1-2", {POS_GK, POS_CB, POS_CB, POS_CB, POS_LM, POS_CM, POS_CM, POS_RM, POS_CAM, POS_ST, POS_ST}},
+    {"3-4-2-1", {POS_GK, POS_CB, POS_CB, POS_CB, POS_LM, POS_CM, POS_CM, POS_RM, POS_LF, POS_RF, POS_ST}},
+    {"3-4-3", {POS_GK, POS_CB, POS_CB, POS_CB, POS_LM, POS_CM, POS_CM, POS_RM, POS_LW, POS_RW, POS_ST}},
+    {"3-5-1-1", {POS_GK, POS_CB, POS_CB, POS_CB, POS_CDM, POS_LM, POS_CM, POS_CM, POS_RM, POS_CAM, POS_ST}},
+    {"3-5-2", {POS_GK, POS_CB, POS_CB, POS_CB, POS_CDM, POS_CDM, POS_LM, POS_CAM, POS_RM, POS_ST, POS_ST}},
 
-    std::vector<std::string> getPositions(const std::string& formationName) const {
-        auto it = formationMap.find(formationName);
-        if (it != formationMap.end()) {
-            return it->second;
-        }
-        return {"Invalid formation"};
+    {"4-1-2-1-2", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_CDM, POS_LM, POS_RM, POS_CAM, POS_ST, POS_ST}},
+    {"4-1-2-1-2 Wide", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_CDM, POS_LM, POS_RM, POS_CAM, POS_ST, POS_ST}},
+    {"4-1-4-1", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_CDM, POS_LM, POS_CM, POS_CM, POS_RM, POS_ST}},
+    {"4-2-2-2", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_CDM, POS_CDM, POS_LAM, POS_RAM, POS_ST, POS_ST}},
+    {"4-2-3-1", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_CDM, POS_CDM, POS_CAM, POS_LM, POS_RM, POS_ST}},
+    {"4-2-3-1 Wide", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_CDM, POS_CDM, POS_CAM, POS_LM, POS_RM, POS_ST}},
+    {"4-3-1-2", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_CM, POS_CM, POS_CM, POS_CAM, POS_ST, POS_ST}},
+    {"4-3-2-1", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_CM, POS_CM, POS_CM, POS_LF, POS_RF, POS_ST}},
+    {"4-3-3", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_CM, POS_CM, POS_CM, POS_LW, POS_RW, POS_ST}},
+    {"4-3-3 Attack", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_CM, POS_CAM, POS_CDM, POS_LW, POS_RW, POS_ST}},
+    {"4-3-3 Defend", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_CDM, POS_CDM, POS_CM, POS_LW, POS_RW, POS_ST}},
+    {"4-3-3 Flat", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_CM, POS_CM, POS_CM, POS_LW, POS_RW, POS_ST}},
+    {"4-3-3 False 9", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_CM, POS_CM, POS_CM, POS_LW, POS_RW, POS_CF}},
+    {"4-4-1-1", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_LM, POS_CM, POS_CM, POS_RM, POS_CF, POS_ST}},
+    {"4-4-2", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_LM, POS_CM, POS_CM, POS_RM, POS_ST, POS_ST}},
+    {"4-4-2 Flat", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_LM, POS_CM, POS_CM, POS_RM, POS_ST, POS_ST}},
+    {"4-4-2 Holding", {POS_GK, POS_LB, POS_CB, POS_CB, POS_RB, POS_LM, POS_CDM, POS_CDM, POS_RM, POS_ST, POS_ST}},
+
+    {"5-2-1-2", {POS_GK, POS_LWB, POS_CB, POS_CB, POS_CB, POS_RWB, POS_CM, POS_CM, POS_CAM, POS_ST, POS_ST}},
+    {"5-2-2-1", {POS_GK, POS_LWB, POS_CB, POS_CB, POS_CB, POS_RWB, POS_CM, POS_CM, POS_LF, POS_RF, POS_ST}},
+    {"5-3-2", {POS_GK, POS_LWB, POS_CB, POS_CB, POS_CB, POS_RWB, POS_CM, POS_CM, POS_CM, POS_ST, POS_ST}},
+    {"5-4-1", {POS_GK, POS_LWB, POS_CB, POS_CB, POS_CB, POS_RWB, POS_LM, POS_CM, POS_CM, POS_RM, POS_ST}}
+};
+
+constexpr int kFormationCount = static_cast<int>(sizeof(kFormations) / sizeof(kFormations[0]));
+
+// Returns the formation called name, or nullptr if there is none
+inline const Formation* FindFormation(const std::string& name) {
+    for (const FormationEntry& entry : kFormations) {
+        if (name == entry.name) return &entry.slots;
     }
+    return nullptr;
+}
+
+inline std::vector<std::string> FormationNames() {
+    std::vector<std::string> names;
+    for (const FormationEntry& entry : kFormations) names.push_back(entry.name);
+    return names;
+}
+
+// Slots that ask for the same position form a group and draw from the same player list
+struct SlotGroups {
+    std::array<int8_t, kSquadSize> previousSameSlot{}; // Closest earlier slot with the same position, -1 if none
+};
 
-    std::vector<std::string> getAllFormationNames() const {
-        std::vector<std::string> keys;
-        for (const auto& kv : formationMap) {
-            keys.push_back(kv.first);
+constexpr SlotGroups MakeSlotGroups(const Formation& formation) {
+    SlotGroups groups;
+    for (int slot = 0; slot < kSquadSize; slot++) {
+        groups.previousSameSlot[slot] = -1;
+        for (int earlier = slot - 1; earlier >= 0; earlier--) {
+            if (formation[earlier] == formation[slot]) {
+                groups.previousSameSlot[slot] = static_cast<int8_t>(earlier);
+                break;
+            }
         }
-        return keys;
     }
-};
+    return groups;
+}
+
+// Bit of every position the formation uses, in the layout of PlayerTable::positionMasks
+constexpr uint32_t FormationPositionMask(const Formation& formation) {
+    uint32_t mask = 0;
+    for (Position position : formation) mask |= PositionBit(position);
+    return mask;
+}
 
 #endif // FORMATIONS_H
@@ -0,0 +1,101 @@
+#ifndef HEURISTIC_H
+#define HEURISTIC_H
+
+#include "PlayerTable.h"
+#include "Requirements.h"
+#include "SearchProfile.h"
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+/*
+  Precomputed lower bound on the cost of filling the rest of a formation [h(n) in A*].
+
+  baseCost[i] is the sum of the cheapest eligible player for every slot from i to the end. On top of that,
+  each nation, league or club quota that is still outstanding forces some of those slots to take a player
+  from its group instead of the cheapest one. extraCost[g][i][q] is the smallest extra that q of the
+  remaining slots can cost for quota g, so the estimate is baseCost[i] + the largest of those extras.
+
+  The estimate never overestimates (every slot pays at least its cheapest player, and at least q of them
+  pay at least their group's cheapest), and it is consistent: filling slot i with any player lowers it by at
+  most what that player costs. With it A* returns the cheapest valid squad.
+*/
+class HeuristicTable {
+public:
+    static constexpr int kInfeasible = INT_MAX;
+
+private:
+    int slotCount = 0;
+    std::vector<QuotaGroup> quotas;
+    std::vector<int> baseCost;                          // [slot], size slotCount + 1
+    std::vector<std::vector<std::vector<int>>> extraCost; // [quota][slot][outstanding]
+
+public:
+    HeuristicTable(const Formation& formation,
+                   const PlayerTable& table,
+                   const PlayerByPosition& playerByPosition,
+                   const std::vector<QuotaGroup>& quotas)
+        : slotCount(static_cast<int>(formation.size())), quotas(quotas) {
+        PROFILE_TIME(TIME_HEURISTIC);
+        // Cheapest player per slot, overall and within each quota group
+        std::vector<int> cheapest(slotCount, kInfeasible);
+        std::vector<std::vector<int>> cheapestInGroup(quotas.size(), std::vector<int>(slotCount, kInfeasible));
+        for (int slot = 0; slot < slotCount; slot++) {
+            for (int row : playerByPosition[formation[slot]]) {
+                int value = table.values[row];
+                cheapest[slot] = std::min(cheapest[slot], value);
+                for (size_t g = 0; g < quotas.size(); g++) {
+                    if (quotas[g].Contains(row, table)) cheapestInGroup[g][slot] = std::min(cheapestInGroup[g][slot], value);
+                }
+            }
+        }
+
+        baseCost.assign(slotCount + 1, 0);
+        for (int slot = slotCount - 1; slot >= 0; slot--) {
+            baseCost[slot] = (cheapest[slot] == kInfeasible || baseCost[slot + 1] == kInfeasible)
+                                 ? kInfeasible : baseCost[slot + 1] + cheapest[slot];
+        }
+
+        // For each quota and start slot: the q smallest group premiums among the remaining slots, summed
+        extraCost.resize(quotas.size());
+        for (size_t g = 0; g < quotas.size(); g++) {
+            extraCost[g].resize(slotCount + 1);
+            for (int slot = 0; slot <= slotCount; slot++) {
+                std::vector<int> premiums;
+                for (int later = slot; later < slotCount; later++) {
+                    if (cheapestInGroup[g][later] != kInfeasible) premiums.push_back(cheapestInGroup[g][later] - cheapest[later]);
+                }
+                std::sort(premiums.begin(), premiums.end());
+
+                std::vector<int>& sums = extraCost[g][slot];
+                sums.assign(quotas[g].count + 1, kInfeasible);
+                sums[0] = 0;
+                for (int q = 1; q <= quotas[g].count && q <= static_cast<int>(premiums.size()); q++) {
+                    sums[q] = sums[q - 1] + premiums[q - 1];
+                }
+            }
+        }
+    }
+
+    const std::vector<QuotaGroup>& Quotas() const { return quotas; }
+
+    // Lower bound on the cost of slots positionIndex.. given how many players each quota still needs.
+    // Returns kInfeasible when the remaining slots cannot be filled or cannot meet the quotas.
+    int Estimate(int positionIndex, const int* outstanding) const {
+        PROFILE_TIME(TIME_HEURISTIC);
+        int base = baseCost[positionIndex];
+        if (base == kInfeasible) return kInfeasible;
+
+        int extra = 0;
+        for (size_t g = 0; g < quotas.size(); g++) {
+            int need = outstanding[g];
+            if (need <= 0) continue;
+            int cost = extraCost[g][positionIndex][need];
+            if (cost == kInfeasible) return kInfeasible;
+            extra = std::max(extra, cost);
+        }
+        return base + extra;
+    }
+};
+
+#endif // HEURISTIC_H
@@ -0,0 +1,118 @@
+#ifndef IDA_STAR_SQUAD_OPTIMIZER_H
+#define IDA_STAR_SQUAD_OPTIMIZER_H
+
+#include "PlayerTable.h"
+#include "Requirements.h"
+#include "SearchProfile.h"
+#include "SquadSearch.h"
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+/*
+  Iterative-deepening A* (IDA*): the same search as AStarSquadOptimizer with memory that does not grow with
+  the search. A* keeps every generated node in its open set, which on loose requirements (big budget, low
+  rating floor) can take all the memory there is. IDA* instead walks the tree depth first and only keeps the
+  path it is on plus the children of each node on it, at most 11 levels of one position list each.
+
+  Each pass only follows nodes with f = g + h up to a threshold. If a pass finds no valid squad, the next one
+  runs with a higher threshold. Plain IDA* raises it to the smallest f that was cut, but squad costs are spread
+  over so many values that this would mean a pass per cost, so the threshold also grows by at least
+  kThresholdGrowth each time. Within a pass the cheapest valid squad found so far cuts every node that cannot
+  beat it, and a pass that finds one ends with the cheapest squad there is: any cheaper squad only passes
+  through nodes with f below its cost, which is under the threshold, so the pass would have visited it.
+
+  It uses the same SquadSearchContext (heuristic, expansion and goal test) as A*, so it returns the same
+  cost. Nodes near the top are expanded again in every pass, and the transposition table is left out to keep
+  memory fixed, so it is slower than A*; it is meant for queries A* cannot finish within the memory available.
+*/
+class IDAStarSearch {
+private:
+    static constexpr double kThresholdGrowth = 0.05; // Smallest relative threshold increase between passes
+
+    const SquadSearchContext& search;
+    ExpansionScratch scratch;
+    std::vector<NodeArena> arenas;                // [depth] nodes of the children being tried at that depth
+    std::vector<std::vector<OpenEntry>> children; // [depth] those children, cheapest f first
+    std::vector<int> squad;
+    SearchStats& stats;
+
+    int threshold = 0;
+    int nextThreshold = INT_MAX; // Smallest f cut by the threshold in this pass
+    size_t frontierSize = 0;     // Children held over all depths
+    std::vector<int> best;
+    int bestCost = INT_MAX;
+
+    void visit(const SquadNode& node) {
+        stats.nodesExpanded++;
+        if (search.IsComplete(node)) {
+            if (search.IsValidSquad(node, squad)) {
+                best = squad;
+                bestCost = node.costSoFar;
+            }
+            return;
+        }
+
+        int depth = node.positionIndex + 1;
+        NodeArena& arena = arenas[depth];
+        std::vector<OpenEntry>& level = children[depth];
+        arena.Reset();
+        level.clear();
+        search.Expand(node, arena, scratch, level);
+        std::sort(level.begin(), level.end(), [](const OpenEntry& a, const OpenEntry& b) { return b > a; });
+        stats.nodesGenerated += level.size();
+        frontierSize += level.size();
+        stats.peakOpenSize = std::max(stats.peakOpenSize, frontierSize);
+
+        for (const OpenEntry& child : level) {
+            // Children are sorted by f, so once one is cut the rest are too
+            if (child.estimatedTotalCost >= bestCost) {
+                PROFILE_COUNT(PRUNE_INCUMBENT);
+                break;
+            }
+            if (child.estimatedTotalCost > threshold) {
+                nextThreshold = std::min(nextThreshold, child.estimatedTotalCost);
+                break;
+            }
+            visit(*child.node);
+        }
+        frontierSize -= level.size();
+    }
+
+public:
+    IDAStarSearch(const SquadSearchContext& search, SearchStats& stats)
+        : search(search), scratch(search.MakeScratch()), arenas(search.GetFormation().size() + 1),
+          children(search.GetFormation().size() + 1), stats(stats) {}
+
+    std::vector<int> Run() {
+        SquadNode* start = search.MakeStart(arenas[0]);
+        if (!start) return {};
+
+        threshold = start->estimatedTotalCost;
+        while (true) {
+            nextThreshold = INT_MAX;
+            visit(*start);
+            if (!best.empty() || nextThreshold == INT_MAX) return best; // Cheapest squad, or nothing left to try
+            threshold = std::max(nextThreshold, threshold + std::max(1, static_cast<int>(threshold * kThresholdGrowth)));
+        }
+    }
+};
+
+// Same contract as AStarSquadOptimizer, with memory bounded by 11 levels of children instead of the open set
+inline std::vector<int> IDAStarSquadOptimizer(
+    const Formation& formation,
+    const PlayerTable& table,
+    const PlayerByPosition& playerByPosition,
+    const SquadRequirements& req,
+    SearchStats* stats = nullptr
+) {
+    SearchStats localStats;
+    SearchStats& counters = stats ? *stats : localStats;
+    PROFILE_SCOPE(&counters.profile);
+
+    SquadSearchContext search(formation, table, playerByPosition, req);
+    IDAStarSearch ida(search, counters);
+    return ida.Run();
+}
+
+#endif // IDA_STAR_SQUAD_OPTIMIZER_H
@@ -0,0 +1,300 @@
+#ifndef LOCAL_SEARCH_H
+#define LOCAL_SEARCH_H
+
+#include "PlayerTable.h"
+#include "Requirements.h"
+#include "SquadHelper.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+/*
+  Simulated annealing on top of Best Fit. Best Fit stops at the first squad that passes, which is often far
+  from the cheapest one. This stage starts from that squad and keeps changing it one player at a time:
+  - replace: a slot gets another player from its position list
+  - swap: a squad player moves to another slot they can play, and their old slot gets a new player from its list
+
+  Both moves take one player out and put one in, so the new cost, rating sum, chemistry and quota counts are
+  worked out from the current ones instead of re-scoring the squad. Squads that break a requirement are
+  allowed along the way but pay a penalty for every missing rating point, chemistry point and quota player,
+  so the search can cross them to reach cheaper valid squads. Only valid squads are ever returned.
+
+  Worse squads are accepted with probability exp(-delta / temperature), and the temperature drops from
+  startTemperature to endTemperature (both relative to the average player value in the start squad) over the
+  run. A fixed number of independent restarts with different seeds are spread over the threads and the
+  cheapest valid squad wins. Each restart is seeded from its index and the restart count does not follow the
+  machine, so the squad is the same whatever the number of cores or threads; only the time changes.
+
+  By default the number of moves follows the size of the formation's player lists, since a small pool is
+  covered long before a fixed budget runs out. A restart also stops once stallIterations moves in a row have
+  not lowered the best energy it has seen.
+*/
+struct LocalSearchOptions {
+    int restarts = 8;               // Independent runs
+    int threads = 0;                // Threads the restarts are spread over, 0 means one per hardware core
+    int iterations = 0;             // Moves tried per restart, 0 means movesPerCandidate per player in the lists
+    int movesPerCandidate = 3;
+    int minIterations = 2000;       // Bounds on the scaled move count
+    int maxIterations = 4000;
+    int stallIterations = 2000;     // Moves without a lower energy before a restart stops, 0 never stops early
+    double startTemperature = 0.5;
+    double endTemperature = 0.005;
+    double swapProbability = 0.2;   // Share of moves that are swaps, the rest are replaces
+    unsigned seed = 1;
+};
+
+// Squad being annealed with the running totals needed to score a move without walking the squad
+class AnnealingSquad {
+private:
+    const PlayerTable& table;
+    const SquadRequirements& req;
+    const std::vector<QuotaGroup>& quotas;
+
+    std::vector<int> rows; // [slot] player in that slot
+    IdentitySet used;
+    ChemistryState chemistry;
+    int cost = 0;
+    int ratingSum = 0;
+    std::vector<int> quotaCounts; // [quota] squad players in the group
+    bool chemistryMatters;        // Without a chemistry target the chemistry state is left alone
+    double penaltyPerPoint;       // Energy added per missing point
+    double budgetPenalty = 2;     // Energy added per unit of value over the budget
+    double energy = 0;            // Energy() of the current squad, kept up to date by Apply
+
+    // Requirement shortfall in "points": rating points, chemistry points and quota players still missing
+    int shortfall(int ratingTotal, int chem, const int* counts) const {
+        int missing = std::max(0, req.minOverallRating * static_cast<int>(rows.size()) - ratingTotal);
+        if (chemistryMatters) missing += std::max(0, req.minTeamChemistry - chem);
+        for (size_t g = 0; g < quotas.size(); g++) missing += std::max(0, quotas[g].count - counts[g]);
+        return missing;
+    }
+
+    double energyOf(int squadCost, int ratingTotal, int chem, const int* counts) const {
+        return squadCost + budgetPenalty * std::max(0, squadCost - req.maxBudget) +
+               penaltyPerPoint * shortfall(ratingTotal, chem, counts);
+    }
+
+public:
+    AnnealingSquad(const PlayerTable& table, const SquadRequirements& req, const std::vector<QuotaGroup>& quotas,
+                   const std::vector<int>& start, double penaltyPerPoint)
+        : table(table), req(req), quotas(quotas), rows(start), used(table.identityCount), quotaCounts(quotas.size(), 0),
+          chemistryMatters(req.minTeamChemistry > 0), penaltyPerPoint(penaltyPerPoint) {
+        for (int row : rows) {
+            used.Insert(table.identityIds[row]);
+            chemistry.Add(row, table);
+            cost += table.values[row];
+            ratingSum += table.ratings[row];
+            for (size_t g = 0; g < quotas.size(); g++) {
+                if (quotas[g].Contains(row, table)) quotaCounts[g]++;
+            }
+        }
+        energy = Energy();
+    }
+
+    const std::vector<int>& Rows() const { return rows; }
+    int Row(int slot) const { return rows[slot]; }
+    int Cost() const { return cost; }
+
+    bool IsValid() const {
+        return cost <= req.maxBudget && shortfall(ratingSum, chemistry.TotalChemistry(), quotaCounts.data()) == 0;
+    }
+
+    double Energy() const { return energyOf(cost, ratingSum, chemistry.TotalChemistry(), quotaCounts.data()); }
+
+    // True if player can join in place of the player in slot (no other version of them is in the squad)
+    bool CanTake(int slot, int player) const {
+        return table.identityIds[player] == table.identityIds[rows[slot]] || !used.Contains(table.identityIds[player]);
+    }
+
+    // Energy change from taking out the player in outSlot and adding player. Only the chemistry state is
+    // touched, and it is put back before returning.
+    double Delta(int outSlot, int player) {
+        int out = rows[outSlot];
+        int nextCost = cost - table.values[out] + table.values[player];
+        int nextRating = ratingSum - table.ratings[out] + table.ratings[player];
+
+        int nextCounts[32];
+        for (size_t g = 0; g < quotas.size() && g < 32; g++) {
+            nextCounts[g] = quotaCounts[g] - (quotas[g].Contains(out, table) ? 1 : 0) + (quotas[g].Contains(player, table) ? 1 : 0);
+        }
+
+        int nextChem = 0;
+        if (chemistryMatters) {
+            chemistry.Remove(out);
+            nextChem = chemistry.TotalChemistryWith(player, table);
+            chemistry.Add(out, table);
+        }
+
+        return energyOf(nextCost, nextRating, nextChem, nextCounts) - energy;
+    }
+
+    // Takes out the player in outSlot, moves the player in moveSlot there (when it differs) and puts player in moveSlot
+    void Apply(int outSlot, int moveSlot, int player) {
+        int out = rows[outSlot];
+        used.Erase(table.identityIds[out]);
+        used.Insert(table.identityIds[player]);
+        if (chemistryMatters) {
+            chemistry.Remove(out);
+            chemistry.Add(player, table);
+        }
+        cost += table.values[player] - table.values[out];
+        ratingSum += table.ratings[player] - table.ratings[out];
+        for (size_t g = 0; g < quotas.size(); g++) {
+            quotaCounts[g] += (quotas[g].Contains(player, table) ? 1 : 0) - (quotas[g].Contains(out, table) ? 1 : 0);
+        }
+        if (moveSlot != outSlot) rows[outSlot] = rows[moveSlot];
+        rows[moveSlot] = player;
+        energy = Energy();
+    }
+};
+
+// One annealing run from start. Returns the cheapest valid squad it saw, or an empty squad if it saw none.
+inline std::vector<int> annealSquad(const Formation& formation,
+                                    const PlayerTable& table,
+                                    const PlayerByPosition& playerByPosition,
+                                    const SquadRequirements& req,
+                                    const std::vector<QuotaGroup>& quotas,
+                                    const std::vector<int>& start,
+                                    const LocalSearchOptions& options,
+                                    unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    int slotCount = static_cast<int>(formation.size());
+    std::uniform_int_distribution<int> pickSlot(0, slotCount - 1);
+
+    // A missing point costs about as much as an average player in the start squad
+    double averageValue = std::max(1.0, static_cast<double>(calculateTotalSquadValue(start, table)) / slotCount);
+    AnnealingSquad squad(table, req, quotas, start, averageValue);
+
+    std::vector<int> best;
+    int bestCost = 0;
+    if (squad.IsValid()) {
+        best = squad.Rows();
+        bestCost = squad.Cost();
+    }
+    double lowestEnergy = squad.Energy();
+    int lastImprovement = 0;
+
+    double temperature = options.startTemperature * averageValue;
+    double endTemperature = options.endTemperature * averageValue;
+    double cooling = options.iterations > 1 ? std::pow(endTemperature / temperature, 1.0 / (options.iterations - 1)) : 1.0;
+
+    for (int iteration = 0; iteration < options.iterations; iteration++, temperature *= cooling) {
+        if (options.stallIterations > 0 && iteration - lastImprovement >= options.stallIterations) break;
+
+        // Pick the slot whose player leaves (outSlot) and the slot the new player fills (inSlot)
+        int outSlot = pickSlot(rng);
+        int inSlot = outSlot;
+        if (unit(rng) < options.swapProbability) {
+            inSlot = pickSlot(rng);
+            if (inSlot == outSlot || !table.PlaysPosition(squad.Row(inSlot), formation[outSlot])) continue;
+        }
+        const std::vector<int>& pool = playerByPosition[formation[inSlot]];
+        if (pool.empty()) continue;
+        int player = pool[std::uniform_int_distribution<int>(0, static_cast<int>(pool.size()) - 1)(rng)];
+        if (player == squad.Row(outSlot) || !squad.CanTake(outSlot, player)) continue;
+        if (inSlot != outSlot && table.identityIds[player] == table.identityIds[squad.Row(inSlot)]) continue;
+
+        double delta = squad.Delta(outSlot, player);
+        if (delta > 0 && unit(rng) >= std::exp(-delta / temperature)) continue;
+
+        squad.Apply(outSlot, inSlot, player);
+        if (squad.Energy() < lowestEnergy) {
+            lowestEnergy = squad.Energy();
+            lastImprovement = iteration;
+        }
+        if (squad.IsValid() && (best.empty() || squad.Cost() < bestCost)) {
+            best = squad.Rows();
+            bestCost = squad.Cost();
+        }
+    }
+    return best;
+}
+
+// Moves per restart when options.iterations is 0: movesPerCandidate for every player in the lists of the
+// formation's positions, within [minIterations, maxIterations]
+inline int scaledIterations(const Formation& formation, const PlayerByPosition& playerByPosition, const LocalSearchOptions& options) {
+    if (options.iterations > 0) return options.iterations;
+    uint32_t counted = 0;
+    long long candidates = 0;
+    for (Position position : formation) {
+        if (counted & PositionBit(position)) continue;
+        counted |= PositionBit(position);
+        candidates += static_cast<long long>(playerByPosition[position].size());
+    }
+    long long moves = candidates * options.movesPerCandidate;
+    return static_cast<int>(std::max<long long>(options.minIterations, std::min<long long>(options.maxIterations, moves)));
+}
+
+// Improves start (Ex: a Best Fit squad) with simulated annealing. If start is empty, every restart begins from
+// its own random squad instead. Returns the cheapest valid squad found, which is never worse than start, or
+// an empty squad if none was found.
+inline std::vector<int> ImproveSquad(const Formation& formation,
+                                     const PlayerTable& table,
+                                     const PlayerByPosition& playerByPosition,
+                                     const SquadRequirements& req,
+                                     const std::vector<int>& start,
+                                     const LocalSearchOptions& options = LocalSearchOptions()) {
+    if (!start.empty() && start.size() != formation.size()) return start;
+
+    std::vector<QuotaGroup> quotas = resolveQuotas(req, table);
+    if (quotas.size() > 32) return start;
+
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    int restarts = std::max(1, options.restarts);
+    int threadCount = std::min(restarts, options.threads > 0 ? options.threads : static_cast<int>(hardware));
+
+    // Without a start squad each restart fills the slots with random players, skipping footballers already in it
+    auto startFor = [&](int restart) {
+        if (!start.empty()) return start;
+        std::mt19937 rng(options.seed * 7919u + restart);
+        std::vector<int> rows;
+        IdentitySet used(table.identityCount);
+        for (Position position : formation) {
+            const std::vector<int>& pool = playerByPosition[position];
+            if (pool.empty()) return std::vector<int>();
+            int row = -1;
+            for (int attempt = 0; attempt < 64 && row < 0; attempt++) {
+                int candidate = pool[std::uniform_int_distribution<int>(0, static_cast<int>(pool.size()) - 1)(rng)];
+                if (!used.Contains(table.identityIds[candidate])) row = candidate;
+            }
+            if (row < 0) return std::vector<int>();
+            used.Insert(table.identityIds[row]);
+            rows.push_back(row);
+        }
+        return rows;
+    };
+
+    LocalSearchOptions runOptions = options;
+    runOptions.iterations = scaledIterations(formation, playerByPosition, options);
+
+    std::vector<std::vector<int>> results(restarts);
+    auto run = [&](int first) {
+        for (int restart = first; restart < restarts; restart += threadCount) {
+            std::vector<int> from = startFor(restart);
+            if (!from.empty()) results[restart] = annealSquad(formation, table, playerByPosition, req, quotas, from, runOptions, options.seed + restart);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threadCount; i++) workers.emplace_back(run, i);
+    run(0);
+    for (std::thread& worker : workers) worker.join();
+
+    // Cheapest valid squad, earliest restart on ties
+    RequirementChecker checker(req, table, static_cast<int>(formation.size()));
+    std::vector<int> best = start;
+    int bestCost = start.empty() ? 0 : calculateTotalSquadValue(start, table);
+    for (const std::vector<int>& squad : results) {
+        if (squad.empty() || !checker.Check(squad, table)) continue;
+        int cost = calculateTotalSquadValue(squad, table);
+        if (best.empty() || cost < bestCost) {
+            best = squad;
+            bestCost = cost;
+        }
+    }
+    return best;
+}
+
+#endif // LOCAL_SEARCH_H
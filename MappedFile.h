@@ -0,0 +1,89 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of a whole file. On POSIX systems the file is memory mapped; elsewhere it falls back to
+// reading the file into a buffer so callers can always treat the contents as one contiguous block.
+// Files that are read front to back once (Ex: the CSV) are opened as sequential so the kernel reads ahead;
+// files that stay mapped and are read in any order (Ex: a snapshot) should not be.
+class MappedFile {
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    std::string buffer; // Only used by the fallback path
+#ifndef _WIN32
+    void* mapping = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { Close(); }
+
+    bool Open(const std::string& filename, bool sequential = true) {
+        Close();
+#ifndef _WIN32
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size = static_cast<size_t>(st.st_size);
+        if (size == 0) {
+            ::close(fd);
+            data = "";
+            return true;
+        }
+
+        mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // The mapping stays valid after the descriptor is closed
+        if (mapping == MAP_FAILED) {
+            mapping = nullptr;
+            size = 0;
+            return false;
+        }
+        if (sequential) ::madvise(mapping, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(mapping);
+        return true;
+#else
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) return false;
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        buffer = contents.str();
+        data = buffer.data();
+        size = buffer.size();
+        return true;
+#endif
+    }
+
+    void Close() {
+#ifndef _WIN32
+        if (mapping) ::munmap(mapping, size);
+        mapping = nullptr;
+#endif
+        buffer.clear();
+        data = nullptr;
+        size = 0;
+    }
+
+    bool IsOpen() const { return data != nullptr; }
+    const char* Data() const { return data; }
+    size_t Size() const { return size; }
+};
+
+#endif // MAPPED_FILE_H
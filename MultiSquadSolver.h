@@ -0,0 +1,564 @@
+#ifndef MULTI_SQUAD_SOLVER_H
+#define MULTI_SQUAD_SOLVER_H
+
+#include "BatchSolver.h"
+#include "Formations.h"
+#include "ParetoFilter.h"
+#include "Player_Organizer.h"
+#include "PlayerTable.h"
+#include "Requirements.h"
+#include "RequirementsIO.h"
+#include "SquadHelper.h"
+#include "SquadOptimizer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <chrono>
+#include <climits>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+  Solves several squads at once when no footballer may be used in more than one of them, Ex: linked
+  challenges that each use up the players handed in, optionally limited to an inventory of owned players.
+
+  Solving the squads one after another and removing the players each one took depends on the order and can
+  cost far more than needed, since the first squad takes the cheapest players even when another squad has
+  no cheap alternative for them. Instead this runs a conflict-based search over the squads:
+  - every node tells each squad which footballers it may not use, and holds each squad's cheapest squad
+    under that ban (found with A*). The sum of those squads never overestimates a joint assignment below
+    the node, because squads only lose players further down.
+  - the node with the lowest bound is taken first. If no footballer is in two of its squads, it is the
+    cheapest joint assignment. Otherwise one shared footballer is picked and the node gets two children: one
+    where the first squad may not use that footballer and one where the second may not. Any joint assignment
+    leaves them out of at least one of the two, so none is lost. Only the squad that lost a player is solved again.
+
+  Pruning across squads:
+  - the sum of separately solved squads ignores that squads compete for the same players. A second bound
+    ignores chemistry and quotas instead and gives every slot of every squad its own footballer from that
+    squad's lists (which already apply the rating floor) at the lowest total value, as a min-cost flow. A node
+    is bounded by the larger of the two. When the flow's squads happen to meet every requirement, they are
+    the cheapest joint assignment under the node and it is closed without branching.
+  - solving the squads one after another (in the order given and most expensive first), then re-solving each
+    against the others until none improves, gives an incumbent before the search starts. A squad solved in a child only
+    has to beat what the incumbent leaves for it, so its A* budget is capped at the incumbent minus the
+    other squads' cost, and nodes whose bound reaches the incumbent are dropped.
+  The per-position lists only depend on the formation and the rating floor, so squads sharing both share
+  one list, restricted to the inventory once when the solver is built.
+
+  With a time or node limit the search returns the incumbent and the lowest open bound, as anytime A* does.
+*/
+
+struct MultiSquadOptions {
+    double timeLimitSeconds = 0; // 0 means no time limit
+    size_t maxNodes = 0;         // Nodes expanded before the incumbent is returned, 0 means no limit
+};
+
+struct MultiSquadResult {
+    std::vector<std::vector<int>> squads; // One per requirement in input order, all empty if none was found
+    long long totalValue = -1;            // Sum over the squads, -1 if no joint assignment was found
+    long long lowerBound = 0;             // No joint assignment costs less than this
+    bool optimal = false;                 // True once the search has proved the squads are the cheapest (or that none exist)
+    size_t nodesExpanded = 0;
+};
+
+// Reads an inventory of owned footballers into owned: one per line, given by player_id or by exact short
+// name (a name owns every footballer with it). Blank lines and lines starting with # are skipped. Returns
+// false if the file cannot be read; entries that match no player are reported and skipped.
+inline bool LoadInventory(const std::string& path, const PlayerTable& table, IdentitySet& owned) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+
+    std::unordered_map<int, int> identityOfPlayerId;
+    std::unordered_map<std::string, std::vector<int>> identitiesOfName;
+    for (size_t row = 0; row < table.Size(); row++) {
+        int identity = table.identityIds[row];
+        if (table.playerIds[row] >= 0) identityOfPlayerId[table.playerIds[row]] = identity;
+        std::vector<int>& named = identitiesOfName[std::string(table.GetName(static_cast<int>(row)))];
+        if (std::find(named.begin(), named.end(), identity) == named.end()) named.push_back(identity);
+    }
+
+    owned = IdentitySet(table.identityCount);
+    std::string line;
+    int unknown = 0;
+    while (std::getline(in, line)) {
+        size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#') continue;
+        std::string entry = line.substr(begin, line.find_last_not_of(" \t\r") - begin + 1);
+
+        bool numeric = std::all_of(entry.begin(), entry.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
+        auto byId = numeric && entry.size() < 10 ? identityOfPlayerId.find(std::stoi(entry)) : identityOfPlayerId.end();
+        auto byName = identitiesOfName.find(entry);
+        if (byId != identityOfPlayerId.end()) {
+            owned.Insert(byId->second);
+        } else if (byName != identitiesOfName.end()) {
+            for (int identity : byName->second) owned.Insert(identity);
+        } else {
+            unknown++;
+        }
+    }
+    if (unknown > 0) std::cerr << "Warning: " << unknown << " inventory entries in " << path << " match no loaded player\n";
+    return true;
+}
+
+class MultiSquadSolver {
+private:
+    struct Node {
+        std::vector<std::vector<int>> banned; // [squad] identity ids that squad may not use, sorted
+        std::vector<std::vector<int>> squads; // [squad] cheapest squad under its ban
+        std::vector<int> costs;
+        long long total = 0; // Sum of costs
+        long long bound = 0; // No joint assignment under this node costs less
+        int conflicts = 0;   // Footballers used by more than one squad
+    };
+
+    // Residual edge of the slot assignment flow
+    struct FlowEdge {
+        int to;
+        int capacity;
+        int cost;
+        int reverse; // Index of the opposite edge in to's list
+        int row;     // Player row for slot -> footballer edges, -1 otherwise
+    };
+
+    const PlayerTable& table;
+    std::vector<SquadRequirements> requirements;
+    std::vector<const Formation*> formations;
+    std::vector<RequirementChecker> checkers;
+    std::vector<std::shared_ptr<const PlayerByPosition>> lists; // [squad] per-position lists, shared by equal keys
+    size_t slotCount = 0;                                       // Slots over all squads
+    MultiSquadOptions options;
+    ThreadPool pool;
+    std::chrono::steady_clock::time_point started;
+
+    // Squads solved without a cap, or found under one, for a squad and ban. A squad found under a cap is
+    // also the cheapest without it, so only misses under a cap are left out.
+    std::mutex memoMutex;
+    std::map<std::pair<size_t, std::vector<int>>, std::vector<int>> memo;
+
+    static int squadCost(const std::vector<int>& squad, const PlayerTable& table) {
+        return squad.empty() ? 0 : calculateTotalSquadValue(squad, table);
+    }
+
+    bool timeUp() const {
+        if (options.timeLimitSeconds <= 0) return false;
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+        return elapsed.count() >= options.timeLimitSeconds;
+    }
+
+    // Per-position lists of requirement s without the banned footballers, Pareto filtered for req
+    PlayerByPosition candidates(size_t s, const std::vector<int>& banned, const SquadRequirements& req) const {
+        PlayerByPosition playerByPosition = *lists[s];
+        if (!banned.empty()) {
+            IdentitySet bannedSet(table.identityCount);
+            for (int identity : banned) bannedSet.Insert(identity);
+            for (std::vector<int>& list : playerByPosition) {
+                list.erase(std::remove_if(list.begin(), list.end(),
+                                          [&](int row) { return bannedSet.Contains(table.identityIds[row]); }),
+                           list.end());
+            }
+        }
+        ParetoFilterPositions(playerByPosition, *formations[s], table, req);
+        return playerByPosition;
+    }
+
+    // Cheapest squad for requirement s that uses no banned footballer and costs at most budgetCap, empty if none
+    std::vector<int> solveSquad(size_t s, const std::vector<int>& banned, int budgetCap) {
+        std::pair<size_t, std::vector<int>> key(s, banned);
+        {
+            std::lock_guard<std::mutex> lock(memoMutex);
+            auto it = memo.find(key);
+            if (it != memo.end()) {
+                const std::vector<int>& known = it->second;
+                if (known.empty() || squadCost(known, table) <= budgetCap) return known;
+                return {};
+            }
+        }
+
+        SquadRequirements req = requirements[s];
+        bool capped = budgetCap < req.maxBudget;
+        req.maxBudget = std::min(req.maxBudget, budgetCap);
+        std::vector<int> squad;
+        if (req.maxBudget >= 0) {
+            PlayerByPosition playerByPosition = candidates(s, banned, req);
+            squad = AStarSquadOptimizer(*formations[s], table, playerByPosition, req);
+        }
+
+        if (!squad.empty() || !capped) {
+            std::lock_guard<std::mutex> lock(memoMutex);
+            memo.emplace(std::move(key), squad);
+        }
+        return squad;
+    }
+
+    // Lowest total value of filling every slot of every squad with a different footballer from its lists,
+    // respecting the node's bans, by successive shortest paths. A slot never needs more than its slotCount
+    // cheapest footballers (the other slots can take at most slotCount - 1 of them), so only those are
+    // linked. Returns -1 if some slot cannot be filled; otherwise squads gets the rows in slot order.
+    long long assignSlots(const Node& node, std::vector<std::vector<int>>& squads) const {
+        const int source = 0;
+        const int firstSlot = 1;
+        std::vector<std::vector<FlowEdge>> graph(firstSlot + slotCount + 1); // Footballer nodes and the sink come after
+        std::unordered_map<int, int> nodeOfIdentity;
+        auto addEdge = [&graph](int from, int to, int cost, int row) {
+            graph[from].push_back({to, 1, cost, static_cast<int>(graph[to].size()), row});
+            graph[to].push_back({from, 0, -cost, static_cast<int>(graph[from].size()) - 1, -1});
+        };
+
+        int slot = firstSlot;
+        for (size_t s = 0; s < formations.size(); s++) {
+            const std::vector<int>& banned = node.banned[s];
+            for (Position position : *formations[s]) {
+                addEdge(source, slot, 0, -1);
+                const std::vector<int>& list = (*lists[s])[position]; // Most expensive first
+                std::vector<int> linked;
+                for (auto it = list.rbegin(); it != list.rend() && linked.size() < slotCount; ++it) {
+                    int identity = table.identityIds[*it];
+                    if (std::binary_search(banned.begin(), banned.end(), identity) ||
+                        std::find(linked.begin(), linked.end(), identity) != linked.end()) continue;
+                    linked.push_back(identity);
+                    auto inserted = nodeOfIdentity.emplace(identity, static_cast<int>(graph.size()));
+                    if (inserted.second) graph.emplace_back();
+                    addEdge(slot, inserted.first->second, table.values[*it], *it);
+                }
+                slot++;
+            }
+        }
+        const int sink = static_cast<int>(graph.size());
+        graph.emplace_back();
+        for (const auto& entry : nodeOfIdentity) addEdge(entry.second, sink, 0, -1);
+
+        long long total = 0;
+        std::vector<long long> distance(graph.size());
+        std::vector<std::pair<int, int>> previous(graph.size()); // (node, edge index) the path came in on
+        std::vector<char> queued(graph.size());
+        for (size_t unit = 0; unit < slotCount; unit++) {
+            std::fill(distance.begin(), distance.end(), LLONG_MAX);
+            distance[source] = 0;
+            std::deque<int> queue(1, source);
+            while (!queue.empty()) {
+                int from = queue.front();
+                queue.pop_front();
+                queued[from] = 0;
+                for (size_t e = 0; e < graph[from].size(); e++) {
+                    const FlowEdge& edge = graph[from][e];
+                    if (edge.capacity == 0 || distance[from] + edge.cost >= distance[edge.to]) continue;
+                    distance[edge.to] = distance[from] + edge.cost;
+                    previous[edge.to] = {from, static_cast<int>(e)};
+                    if (!queued[edge.to]) {
+                        queued[edge.to] = 1;
+                        queue.push_back(edge.to);
+                    }
+                }
+            }
+            if (distance[sink] == LLONG_MAX) return -1;
+            total += distance[sink];
+            for (int at = sink; at != source; at = previous[at].first) {
+                FlowEdge& edge = graph[previous[at].first][previous[at].second];
+                edge.capacity--;
+                graph[at][edge.reverse].capacity++;
+            }
+        }
+
+        squads.assign(formations.size(), {});
+        slot = firstSlot;
+        for (size_t s = 0; s < formations.size(); s++) {
+            for (size_t k = 0; k < formations[s]->size(); k++, slot++) {
+                for (const FlowEdge& edge : graph[slot]) {
+                    if (edge.row >= 0 && edge.capacity == 0) squads[s].push_back(edge.row);
+                }
+            }
+        }
+        return total;
+    }
+
+    // Counts the footballers used by more than one squad of node and returns the first of them as (identity,
+    // squad, other squad)
+    int findConflicts(const Node& node, int& identity, size_t& first, size_t& second) const {
+        std::unordered_map<int, size_t> squadOfIdentity;
+        int conflicts = 0;
+        for (size_t s = 0; s < node.squads.size(); s++) {
+            for (int row : node.squads[s]) {
+                auto inserted = squadOfIdentity.emplace(table.identityIds[row], s);
+                if (inserted.second) continue;
+                if (conflicts++ == 0) {
+                    identity = table.identityIds[row];
+                    first = inserted.first->second;
+                    second = s;
+                }
+            }
+        }
+        return conflicts;
+    }
+
+    // Fills in node's bound and conflicts. Takes the slot assignment as the incumbent if it meets every
+    // requirement and is cheaper. Returns false if nothing under node can beat the incumbent.
+    bool evaluate(Node& node, std::vector<std::vector<int>>& best, long long& bestTotal) const {
+        std::vector<std::vector<int>> assigned;
+        long long assignedTotal = assignSlots(node, assigned);
+        if (assignedTotal < 0) return false;
+        node.bound = std::max(node.total, assignedTotal);
+
+        bool valid = true;
+        for (size_t s = 0; s < assigned.size() && valid; s++) valid = checkers[s].Check(assigned[s], table);
+        if (valid && assignedTotal < bestTotal) {
+            best = assigned;
+            bestTotal = assignedTotal;
+        }
+        if (node.bound >= bestTotal) return false;
+
+        int identity;
+        size_t first, second;
+        node.conflicts = findConflicts(node, identity, first, second);
+        return true;
+    }
+
+    // Fills the squads one at a time in order, each the cheapest squad (A*) without the footballers already
+    // taken, as when the squads are solved by hand one after another. Returns false if one cannot be filled.
+    bool sequentialAssignment(const std::vector<size_t>& order, std::vector<std::vector<int>>& squads, long long& total) {
+        squads.assign(order.size(), {});
+        total = 0;
+        std::vector<int> taken;
+        for (size_t s : order) {
+            if (timeUp()) return false;
+            squads[s] = solveSquad(s, taken, INT_MAX);
+            if (squads[s].empty()) return false;
+            total += squadCost(squads[s], table);
+            for (int row : squads[s]) taken.push_back(table.identityIds[row]);
+            std::sort(taken.begin(), taken.end());
+            taken.erase(std::unique(taken.begin(), taken.end()), taken.end());
+        }
+        return true;
+    }
+
+    // Improves squads in place: each squad in turn is solved again with A* against the footballers of the
+    // others, capped below its current cost, until a whole round changes nothing
+    void improveAssignment(std::vector<std::vector<int>>& squads, long long& total) {
+        for (bool improved = true; improved && !timeUp();) {
+            improved = false;
+            for (size_t s = 0; s < squads.size() && !timeUp(); s++) {
+                std::vector<int> taken;
+                for (size_t other = 0; other < squads.size(); other++) {
+                    if (other == s) continue;
+                    for (int row : squads[other]) taken.push_back(table.identityIds[row]);
+                }
+                std::sort(taken.begin(), taken.end());
+                taken.erase(std::unique(taken.begin(), taken.end()), taken.end());
+
+                int cost = squadCost(squads[s], table);
+                std::vector<int> squad = solveSquad(s, taken, cost - 1);
+                if (squad.empty()) continue;
+                total += squadCost(squad, table) - cost;
+                squads[s] = std::move(squad);
+                improved = true;
+            }
+        }
+    }
+
+public:
+    // requirements must hold known formations (as ParseRequirementsJSON checks). With an inventory only the
+    // footballers in it are used. threadCount = 0 uses one thread per hardware core.
+    MultiSquadSolver(const PlayerOrganizer& organizer, const std::vector<SquadRequirements>& requirements,
+                     const IdentitySet* inventory = nullptr, unsigned threadCount = 0,
+                     const MultiSquadOptions& options = MultiSquadOptions())
+        : table(organizer.GetAllPlayers()), requirements(requirements), options(options), pool(threadCount) {
+        std::map<std::pair<uint32_t, int>, std::shared_ptr<const PlayerByPosition>> shared; // Same key as BatchSolver's lists
+        for (const SquadRequirements& req : requirements) {
+            formations.push_back(FindFormation(req.formation));
+            checkers.emplace_back(req, table, static_cast<int>(formations.back()->size()));
+            slotCount += formations.back()->size();
+            std::shared_ptr<const PlayerByPosition>& list = shared[{FormationPositionMask(*formations.back()), req.minOverallRating}];
+            if (!list) {
+                PlayerByPosition built = BuildPlayerByPosition(organizer, *formations.back(), req.minOverallRating);
+                if (inventory) {
+                    for (std::vector<int>& positionList : built) {
+                        positionList.erase(std::remove_if(positionList.begin(), positionList.end(),
+                                                          [&](int row) { return !inventory->Contains(table.identityIds[row]); }),
+                                           positionList.end());
+                    }
+                }
+                list = std::make_shared<const PlayerByPosition>(std::move(built));
+            }
+            lists.push_back(list);
+        }
+    }
+
+    MultiSquadResult Run() {
+        started = std::chrono::steady_clock::now();
+        MultiSquadResult result;
+        size_t count = requirements.size();
+        result.squads.assign(count, {});
+
+        // Root: every squad on its own. If one has no squad even then, no joint assignment exists.
+        Node root;
+        root.banned.assign(count, {});
+        root.squads.assign(count, {});
+        root.costs.assign(count, 0);
+        for (size_t s = 0; s < count; s++) {
+            pool.Submit([this, &root, s]() { root.squads[s] = solveSquad(s, {}, INT_MAX); });
+        }
+        pool.Wait();
+        for (size_t s = 0; s < count; s++) {
+            if (root.squads[s].empty()) {
+                result.optimal = true;
+                return result;
+            }
+            root.costs[s] = squadCost(root.squads[s], table);
+            root.total += root.costs[s];
+        }
+
+        // The root's slot assignment often settles it already; otherwise a greedy incumbent is built to prune with
+        std::vector<std::vector<int>> best;
+        long long bestTotal = LLONG_MAX;
+        bool rootOpen = evaluate(root, best, bestTotal);
+        if (rootOpen && bestTotal == LLONG_MAX) {
+            // The squads in the order given and most expensive first, each then re-solved against the others
+            std::vector<size_t> orders[2];
+            for (size_t s = 0; s < count; s++) orders[0].push_back(s);
+            orders[1] = orders[0];
+            std::stable_sort(orders[1].begin(), orders[1].end(), [&](size_t a, size_t b) { return root.costs[a] > root.costs[b]; });
+            for (const std::vector<size_t>& order : orders) {
+                std::vector<std::vector<int>> greedy;
+                long long greedyTotal = LLONG_MAX;
+                if (!sequentialAssignment(order, greedy, greedyTotal)) continue;
+                improveAssignment(greedy, greedyTotal);
+                if (greedyTotal < bestTotal) {
+                    best = std::move(greedy);
+                    bestTotal = greedyTotal;
+                }
+            }
+            rootOpen = root.bound < bestTotal;
+        }
+
+        // Open nodes, lowest bound first. Squads usually have many equally cheap alternatives, so among nodes
+        // with the same bound the one with the fewest conflicts goes first, then the newest one.
+        std::vector<Node> nodes;
+        auto worse = [&nodes](size_t a, size_t b) {
+            if (nodes[a].bound != nodes[b].bound) return nodes[a].bound > nodes[b].bound;
+            if (nodes[a].conflicts != nodes[b].conflicts) return nodes[a].conflicts > nodes[b].conflicts;
+            return a < b;
+        };
+        std::priority_queue<size_t, std::vector<size_t>, decltype(worse)> open(worse);
+        if (rootOpen) {
+            nodes.push_back(std::move(root));
+            open.push(0);
+        }
+
+        bool limitHit = false;
+        while (!open.empty()) {
+            size_t index = open.top();
+            if (nodes[index].bound >= bestTotal) break; // Nothing left open can beat the incumbent
+            if ((options.maxNodes > 0 && result.nodesExpanded >= options.maxNodes) || timeUp()) {
+                limitHit = true;
+                result.lowerBound = nodes[index].bound;
+                break;
+            }
+            open.pop();
+            result.nodesExpanded++;
+
+            int identity;
+            size_t first, second;
+            if (findConflicts(nodes[index], identity, first, second) == 0) {
+                best = nodes[index].squads;
+                bestTotal = nodes[index].total;
+                break;
+            }
+
+            // One child per squad of the conflict, solved in parallel. The parent is moved out first, since
+            // adding the children can move it.
+            Node parent = std::move(nodes[index]);
+            nodes[index] = Node(); // Expanded, only its slot index is kept
+            Node children[2] = {parent, parent};
+            size_t changed[2] = {first, second};
+            for (int c = 0; c < 2; c++) {
+                Node& child = children[c];
+                size_t s = changed[c];
+                std::vector<int>& banned = child.banned[s];
+                banned.insert(std::upper_bound(banned.begin(), banned.end(), identity), identity);
+                long long cap = bestTotal == LLONG_MAX ? INT_MAX : bestTotal - 1 - (parent.total - parent.costs[s]);
+                int budgetCap = static_cast<int>(std::min<long long>(cap, INT_MAX));
+                pool.Submit([this, &child, s, budgetCap]() { child.squads[s] = solveSquad(s, child.banned[s], budgetCap); });
+            }
+            pool.Wait();
+
+            for (int c = 0; c < 2; c++) {
+                Node& child = children[c];
+                size_t s = changed[c];
+                if (child.squads[s].empty()) continue; // No squad without that footballer that could beat the incumbent
+                child.total += squadCost(child.squads[s], table) - child.costs[s];
+                child.costs[s] = squadCost(child.squads[s], table);
+                if (!evaluate(child, best, bestTotal)) continue;
+                nodes.push_back(std::move(child));
+                open.push(nodes.size() - 1);
+            }
+        }
+
+        if (bestTotal == LLONG_MAX) {
+            result.optimal = !limitHit; // Every branch was closed without a joint assignment
+            return result;
+        }
+        result.squads = best;
+        result.totalValue = bestTotal;
+        result.lowerBound = limitHit ? std::min(result.lowerBound, bestTotal) : bestTotal;
+        result.optimal = result.lowerBound >= bestTotal;
+        return result;
+    }
+};
+
+// Batch mode with --joint: reads every record from in, solves them together and writes one result line per
+// record in input order, then a summary line. Returns the number of records that could not be parsed (nothing
+// is solved if there are any), or 1 if no joint assignment was found.
+inline int SolveJointBatch(std::istream& in, std::ostream& out, const PlayerOrganizer& organizer,
+                           const IdentitySet* inventory, unsigned threadCount,
+                           const MultiSquadOptions& options = MultiSquadOptions()) {
+    std::vector<SquadRequirements> requirements;
+    std::vector<std::string> ids;
+    int failed = 0;
+    int lineNumber = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        SquadRequirements req;
+        std::string id, error;
+        if (!ParseRequirementsJSON(line, req, id, error)) {
+            failed++;
+            out << "{\"line\": " << lineNumber << ", \"error\": \"" << jsonEscape(error) << "\"}\n";
+            continue;
+        }
+        requirements.push_back(req);
+        ids.push_back(id.empty() ? std::to_string(lineNumber) : id);
+    }
+    if (failed > 0) return failed;
+
+    auto start = std::chrono::steady_clock::now();
+    MultiSquadSolver solver(organizer, requirements, inventory, threadCount, options);
+    MultiSquadResult result = solver.Run();
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+
+    const PlayerTable& table = organizer.GetAllPlayers();
+    for (size_t s = 0; s < requirements.size(); s++) {
+        out << "{\"id\": \"" << jsonEscape(ids[s]) << "\", \"algorithm\": \"joint\", "
+            << SquadJSONFields(*FindFormation(requirements[s].formation), table, result.squads[s]) << "}\n";
+    }
+    std::ostringstream summary;
+    summary << "{\"squads\": " << requirements.size() << ", \"found\": " << (result.totalValue >= 0 ? "true" : "false");
+    if (result.totalValue >= 0) summary << ", \"totalValue\": " << result.totalValue << ", \"lowerBound\": " << result.lowerBound;
+    summary << ", \"optimal\": " << (result.optimal ? "true" : "false") << ", \"nodes\": " << result.nodesExpanded
+            << ", \"ms\": " << duration.count() << "}";
+    out << summary.str() << "\n";
+    return result.totalValue >= 0 ? 0 : 1;
+}
+
+#endif // MULTI_SQUAD_SOLVER_H
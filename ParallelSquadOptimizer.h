@@ -0,0 +1,230 @@
+#ifndef PARALLEL_SQUAD_OPTIMIZER_H
+#define PARALLEL_SQUAD_OPTIMIZER_H
+
+#include "PlayerTable.h"
+#include "Requirements.h"
+#include "SearchProfile.h"
+#include "SquadSearch.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+  Hash-distributed A* (HDA*). Every partial squad has an owner thread picked from its squadHash, and only
+  the owner ever puts it on an open list or checks it against the expanded set. So each thread keeps a
+  private open list and a private TranspositionTable shard, and no lock is held while either is used.
+
+  A thread pops its best node, expands it with its own arena and scratch buffers and routes each child to
+  its owner: children it owns go straight onto its open list, the rest are batched per owner and appended
+  to that owner's inbox under the inbox's own lock. Nodes with the same players have the same squadHash, so
+  they always meet in the same shard and transpositions are still caught.
+
+  A full squad that passes the requirements becomes the incumbent. Because the heuristic never
+  overestimates, no node with f >= the incumbent's cost can lead to anything cheaper, so those are dropped.
+  A thread with nothing cheaper than the incumbent left goes idle. The search ends when every thread is idle
+  and no batch is waiting in an inbox, which one counter tracks (see work). The result is the same cheapest
+  cost the serial search finds; which of several equally cheap squads is returned may differ.
+*/
+class ParallelSquadSearch {
+private:
+    using OpenList = std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>>;
+
+    // Nodes other threads have handed to one thread, waiting to be moved onto its open list
+    struct Inbox {
+        std::mutex mutex;
+        std::condition_variable arrived;
+        std::vector<OpenEntry> entries;
+    };
+
+    const SquadSearchContext& search;
+    int threadCount = 1;
+    std::vector<std::unique_ptr<Inbox>> inboxes; // [thread]
+
+    // Threads that are not idle plus nodes sitting in inboxes. A sender adds its batch before letting go of
+    // it and a woken thread counts itself back in before taking its inbox, so the count can only reach zero
+    // when nothing is running and nothing is waiting.
+    std::atomic<long long> work{0};
+    std::atomic<bool> done{false};
+
+    std::atomic<int> bestCost{INT_MAX}; // Cost of the incumbent, read without a lock for pruning
+    std::mutex bestMutex;               // Guards bestSquad and the stats merge
+    std::vector<int> bestSquad;
+    SearchStats stats;
+
+    int ownerOf(const SquadNode* node) const {
+        return static_cast<int>((node->squadHash >> 32) % static_cast<uint64_t>(threadCount));
+    }
+
+    void send(int owner, std::vector<OpenEntry>& batch) {
+        Inbox& inbox = *inboxes[owner];
+        work.fetch_add(static_cast<long long>(batch.size()));
+        {
+            std::lock_guard<std::mutex> lock(inbox.mutex);
+            inbox.entries.insert(inbox.entries.end(), batch.begin(), batch.end());
+        }
+        inbox.arrived.notify_one();
+        batch.clear();
+    }
+
+    void finish() {
+        done.store(true);
+        for (std::unique_ptr<Inbox>& inbox : inboxes) {
+            std::lock_guard<std::mutex> lock(inbox->mutex);
+            inbox->arrived.notify_all();
+        }
+    }
+
+    void worker(int id, NodeArena& arena) {
+        Inbox& inbox = *inboxes[id];
+        OpenList open;
+        TranspositionTable expanded(search.GetFormation()); // This thread's shard
+        ExpansionScratch scratch = search.MakeScratch();
+        std::vector<OpenEntry> children;
+        std::vector<std::vector<OpenEntry>> outgoing(threadCount); // [owner] children routed to another thread
+        std::vector<OpenEntry> received;
+        std::vector<int> squad;
+        SearchStats local;
+        SearchProfile profile; // This thread's share of stats.profile, merged in when it stops
+        PROFILE_SCOPE(&profile);
+
+        while (!done.load()) {
+            // Move whatever other threads sent onto the open list
+            {
+                std::lock_guard<std::mutex> lock(inbox.mutex);
+                received.swap(inbox.entries);
+            }
+            if (!received.empty()) {
+                for (const OpenEntry& entry : received) {
+                    if (entry.estimatedTotalCost < bestCost.load(std::memory_order_relaxed)) open.push(entry);
+                }
+                work.fetch_sub(static_cast<long long>(received.size()));
+                received.clear();
+            }
+
+            if (open.empty() || open.top().estimatedTotalCost >= bestCost.load(std::memory_order_relaxed)) {
+                // Nothing here can beat the incumbent. Go idle until another thread sends something.
+                std::unique_lock<std::mutex> lock(inbox.mutex);
+                if (!inbox.entries.empty()) continue;
+                if (work.fetch_sub(1) == 1) {
+                    lock.unlock();
+                    finish();
+                    break;
+                }
+                inbox.arrived.wait(lock, [&]() { return done.load() || !inbox.entries.empty(); });
+                if (done.load()) break;
+                work.fetch_add(1);
+                continue;
+            }
+
+            const SquadNode& current = *open.top().node;
+            local.nodesExpanded++;
+            local.peakOpenSize = std::max(local.peakOpenSize, open.size());
+            open.pop();
+
+            if (search.IsComplete(current)) {
+                if (search.IsValidSquad(current, squad) && current.costSoFar < bestCost.load()) {
+                    std::lock_guard<std::mutex> lock(bestMutex);
+                    if (current.costSoFar < bestCost.load()) {
+                        bestCost.store(current.costSoFar);
+                        bestSquad = squad;
+                    }
+                }
+                continue;
+            }
+            if (!expanded.Insert(&current)) {
+                local.transpositions++;
+                continue;
+            }
+
+            children.clear();
+            search.Expand(current, arena, scratch, children);
+            int incumbent = bestCost.load(std::memory_order_relaxed);
+            for (const OpenEntry& child : children) {
+                if (child.estimatedTotalCost >= incumbent) {
+                    PROFILE_COUNT(PRUNE_INCUMBENT);
+                    continue;
+                }
+                local.nodesGenerated++;
+                int owner = ownerOf(child.node);
+                if (owner == id) {
+                    open.push(child);
+                } else {
+                    outgoing[owner].push_back(child);
+                }
+            }
+            for (int owner = 0; owner < threadCount; owner++) {
+                if (!outgoing[owner].empty()) send(owner, outgoing[owner]);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(bestMutex);
+        stats.nodesExpanded += local.nodesExpanded;
+        stats.nodesGenerated += local.nodesGenerated;
+        stats.transpositions += local.transpositions;
+        stats.peakOpenSize += local.peakOpenSize; // Sum of the per-thread peaks, an upper bound on the total
+        stats.profile.Merge(profile);
+    }
+
+public:
+    explicit ParallelSquadSearch(const SquadSearchContext& search) : search(search) {}
+
+    std::vector<int> Run(int requestedThreads) {
+        threadCount = std::max(1, requestedThreads);
+        inboxes.clear();
+        for (int i = 0; i < threadCount; i++) inboxes.push_back(std::make_unique<Inbox>());
+
+        // Every thread allocates from its own arena. Nodes are read across threads through parent pointers,
+        // which is safe since a node is never written again after it is handed over through an inbox.
+        std::vector<NodeArena> arenas(threadCount);
+
+        SquadNode* start = search.MakeStart(arenas[0]);
+        if (!start) return {};
+        work.store(threadCount);
+        std::vector<OpenEntry> first = {{start->estimatedTotalCost, start->positionIndex, start}};
+        send(ownerOf(start), first);
+
+        std::vector<std::thread> threads;
+        for (int i = 1; i < threadCount; i++) {
+            threads.emplace_back([this, &arenas, i]() { worker(i, arenas[i]); });
+        }
+        worker(0, arenas[0]);
+        for (std::thread& thread : threads) thread.join();
+
+        return bestSquad;
+    }
+
+    const SearchStats& Stats() const { return stats; }
+};
+
+// Same contract as AStarSquadOptimizer, spread over threadCount threads. threadCount <= 0 uses every core.
+inline std::vector<int> ParallelAStarSquadOptimizer(
+    const Formation& formation,
+    const PlayerTable& table,
+    const PlayerByPosition& playerByPosition,
+    const SquadRequirements& req,
+    int threadCount,
+    SearchStats* stats = nullptr
+) {
+    if (threadCount <= 0) threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    SearchProfile setup; // Building the search context, before the workers start
+    PROFILE_SCOPE(&setup);
+    SquadSearchContext search(formation, table, playerByPosition, req);
+    ParallelSquadSearch parallel(search);
+    std::vector<int> squad = parallel.Run(threadCount);
+    if (stats) {
+        *stats = parallel.Stats();
+        stats->profile.Merge(setup);
+    }
+    return squad;
+}
+
+#endif // PARALLEL_SQUAD_OPTIMIZER_H
@@ -0,0 +1,112 @@
+#ifndef PARETO_FILTER_H
+#define PARETO_FILTER_H
+
+#include "PlayerTable.h"
+#include "Requirements.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+  Drops players from the position pools who can never be needed in a cheapest valid squad.
+
+  Players in the same dominance group are interchangeable as far as chemistry and quotas go. Within a
+  group, q dominates p when q costs no more and is rated no lower (ties broken by row so that of two
+  identical players only the later one is dominated). If p is in a squad, one of its dominators can take its
+  place without breaking any requirement or raising the cost, unless every dominator is already in the squad
+  or is another version of someone in it. The other slots can block at most slotCount - 1 footballers, so p
+  is only kept while fewer than slotCount distinct footballers dominate it.
+
+  The groups depend on what the requirements look at. With a chemistry target, club, nation and league all
+  count, so the group is that exact triple. Without one, only membership in the requested nation, league
+  and club quotas matters, and everyone outside them falls into one group per position.
+*/
+class DominanceGroups {
+private:
+    bool exact;
+    std::vector<int> nationQuota; // Nation id -> index of its quota + 1, 0 if not requested
+    std::vector<int> leagueQuota;
+    std::vector<int> clubQuota;
+
+    static std::vector<int> quotaIndexes(const StringPool& pool, const std::vector<std::string>& names) {
+        std::vector<int> indexes(pool.Size(), 0);
+        for (size_t i = 0; i < names.size(); i++) {
+            int id = pool.Find(names[i]);
+            if (id >= 0 && indexes[id] == 0) indexes[id] = static_cast<int>(i) + 1;
+        }
+        return indexes;
+    }
+
+public:
+    DominanceGroups(const SquadRequirements& req, const PlayerTable& table)
+        : exact(req.minTeamChemistry > 0),
+          nationQuota(quotaIndexes(table.nations, req.nations)),
+          leagueQuota(quotaIndexes(table.leagues, req.leagues)),
+          clubQuota(quotaIndexes(table.clubs, req.clubs)) {}
+
+    uint64_t Of(int row, const PlayerTable& table) const {
+        if (exact) {
+            return (static_cast<uint64_t>(table.clubIds[row]) << 42) | (static_cast<uint64_t>(table.nationIds[row]) << 21) |
+                   static_cast<uint64_t>(table.leagueIds[row]);
+        }
+        return (static_cast<uint64_t>(clubQuota[table.clubIds[row]]) << 32) |
+               (static_cast<uint64_t>(nationQuota[table.nationIds[row]]) << 16) |
+               static_cast<uint64_t>(leagueQuota[table.leagueIds[row]]);
+    }
+};
+
+// Removes the dominated players from one pool, keeping the order of the rest
+inline void ParetoFilterPool(std::vector<int>& rows, const PlayerTable& table, const DominanceGroups& groups, int slotCount) {
+    if (slotCount <= 0 || rows.size() <= static_cast<size_t>(slotCount)) return;
+
+    // Group the pool, cheapest (then best rated) first within each group
+    std::vector<std::pair<uint64_t, int>> order;
+    order.reserve(rows.size());
+    for (int row : rows) order.emplace_back(groups.Of(row, table), row);
+    std::sort(order.begin(), order.end(), [&](const std::pair<uint64_t, int>& a, const std::pair<uint64_t, int>& b) {
+        if (a.first != b.first) return a.first < b.first;
+        if (table.values[a.second] != table.values[b.second]) return table.values[a.second] < table.values[b.second];
+        if (table.ratings[a.second] != table.ratings[b.second]) return table.ratings[a.second] > table.ratings[b.second];
+        return a.second < b.second;
+    });
+
+    std::vector<int> dominated;
+    std::unordered_map<int, int> bestRatingOfIdentity; // Within the current group: identity id -> best rating so far
+    for (size_t i = 0; i < order.size(); i++) {
+        int p = order[i].second;
+        if (i == 0 || order[i].first != order[i - 1].first) bestRatingOfIdentity.clear();
+
+        // Everyone seen so far in the group costs no more than p; count the footballers among them rated at least as well
+        int dominators = 0;
+        for (const auto& entry : bestRatingOfIdentity) {
+            if (entry.second >= table.ratings[p] && ++dominators >= slotCount) break;
+        }
+        if (dominators >= slotCount) dominated.push_back(p);
+
+        auto it = bestRatingOfIdentity.find(table.identityIds[p]);
+        if (it == bestRatingOfIdentity.end()) bestRatingOfIdentity.emplace(table.identityIds[p], table.ratings[p]);
+        else it->second = std::max(it->second, table.ratings[p]);
+    }
+    if (dominated.empty()) return;
+
+    std::sort(dominated.begin(), dominated.end());
+    rows.erase(std::remove_if(rows.begin(), rows.end(), [&](int row) {
+        return std::binary_search(dominated.begin(), dominated.end(), row);
+    }), rows.end());
+}
+
+// Filters every pool of playerByPosition for the given requirements
+inline void ParetoFilterPositions(PlayerByPosition& playerByPosition,
+                                  const Formation& formation,
+                                  const PlayerTable& table,
+                                  const SquadRequirements& req) {
+    DominanceGroups groups(req, table);
+    for (std::vector<int>& pool : playerByPosition) {
+        ParetoFilterPool(pool, table, groups, static_cast<int>(formation.size()));
+    }
+}
+
+#endif // PARETO_FILTER_H
@@ -0,0 +1,334 @@
+#ifndef PLAYER_TABLE_H
+#define PLAYER_TABLE_H
+
+#include "MappedFile.h"
+#include "Positions.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+
+// Maps each distinct string (nation, league, club, position or name) to a small integer id.
+// Ids are handed out in insertion order, so they can be used directly as array indexes.
+//
+// A pool loaded from a snapshot reads its strings straight from the mapped file (an offset table and one
+// block of characters) and only stores the strings interned after that itself. The string -> id hash is
+// built the first time Find or Intern needs it, since most runs only turn ids back into names.
+class StringPool {
+private:
+    std::shared_ptr<const MappedFile> source; // Keeps the mapped strings alive, null when nothing is mapped
+    const uint32_t* offsets = nullptr;        // [id] start of mapped string id in chars, mappedCount + 1 entries
+    const char* chars = nullptr;
+    size_t mappedCount = 0;
+    std::deque<std::string> added;            // A deque so the views in ids stay valid as it grows
+
+    mutable std::unordered_map<std::string_view, int> ids;
+    mutable std::atomic<bool> indexed{false};
+    mutable std::mutex indexMutex; // Find can be called from several solver threads at once
+
+    void buildIndex() const {
+        if (indexed.load(std::memory_order_acquire)) return;
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (indexed.load(std::memory_order_relaxed)) return;
+        ids.reserve(Size());
+        for (size_t id = 0; id < Size(); id++) ids.emplace(Get(static_cast<int>(id)), static_cast<int>(id));
+        indexed.store(true, std::memory_order_release);
+    }
+
+public:
+    StringPool() = default;
+    StringPool(const StringPool& other) { *this = other; }
+    StringPool(StringPool&& other) noexcept { *this = std::move(other); }
+
+    // A copy rebuilds its own hash when it needs one, since the views in other's point into other's strings
+    StringPool& operator=(const StringPool& other) {
+        if (this == &other) return *this;
+        source = other.source;
+        offsets = other.offsets;
+        chars = other.chars;
+        mappedCount = other.mappedCount;
+        added = other.added;
+        ids.clear();
+        indexed.store(false, std::memory_order_relaxed);
+        return *this;
+    }
+
+    // Moving a deque keeps its strings where they are, so the hash moves along
+    StringPool& operator=(StringPool&& other) noexcept {
+        if (this == &other) return *this;
+        source = std::move(other.source);
+        offsets = other.offsets;
+        chars = other.chars;
+        mappedCount = other.mappedCount;
+        added = std::move(other.added);
+        ids = std::move(other.ids);
+        indexed.store(other.indexed.load(std::memory_order_acquire), std::memory_order_relaxed);
+        other.offsets = nullptr;
+        other.chars = nullptr;
+        other.mappedCount = 0;
+        other.added.clear();
+        other.ids.clear();
+        other.indexed.store(false, std::memory_order_relaxed);
+        return *this;
+    }
+
+    // Replaces the contents with count strings stored in file: string id is chars[offsets[id], offsets[id + 1])
+    void Map(std::shared_ptr<const MappedFile> file, const uint32_t* stringOffsets, const char* stringChars, size_t count) {
+        source = std::move(file);
+        offsets = stringOffsets;
+        chars = stringChars;
+        mappedCount = count;
+        added.clear();
+        ids.clear();
+        indexed.store(false, std::memory_order_relaxed);
+    }
+
+    // Returns the id of str, adding it to the pool if it has not been seen before
+    int Intern(std::string_view str) {
+        buildIndex();
+        auto it = ids.find(str);
+        if (it != ids.end()) return it->second;
+
+        int id = static_cast<int>(Size());
+        added.emplace_back(str);
+        ids.emplace(added.back(), id);
+        return id;
+    }
+
+    // Returns the id of str, or -1 if it was never interned
+    int Find(std::string_view str) const {
+        buildIndex();
+        auto it = ids.find(str);
+        return it != ids.end() ? it->second : -1;
+    }
+
+    std::string_view Get(int id) const {
+        if (static_cast<size_t>(id) < mappedCount) return std::string_view(chars + offsets[id], offsets[id + 1] - offsets[id]);
+        return added[static_cast<size_t>(id) - mappedCount];
+    }
+
+    size_t Size() const { return mappedCount + added.size(); }
+};
+
+// One column of the PlayerTable. It either owns its values or views a column of a mapped snapshot; the first
+// change to a viewed column copies it, so a table loaded from a snapshot never copies what it only reads.
+template <typename T>
+class Column {
+private:
+    std::vector<T> owned;
+    std::shared_ptr<const MappedFile> source; // Set while the column views a mapped file
+    const T* first = nullptr;
+    size_t count = 0;
+
+    void sync() {
+        first = owned.data();
+        count = owned.size();
+    }
+
+    void own() {
+        if (!source) return;
+        owned.assign(first, first + count);
+        source.reset();
+        sync();
+    }
+
+public:
+    using value_type = T;
+
+    Column() = default;
+    Column(const Column& other) { *this = other; }
+    Column(Column&& other) noexcept { *this = std::move(other); }
+
+    Column& operator=(const Column& other) {
+        if (this == &other) return *this;
+        owned = other.owned;
+        source = other.source;
+        if (source) {
+            first = other.first;
+            count = other.count;
+        } else {
+            sync();
+        }
+        return *this;
+    }
+
+    Column& operator=(Column&& other) noexcept {
+        if (this == &other) return *this;
+        owned = std::move(other.owned);
+        source = std::move(other.source);
+        if (source) {
+            first = other.first;
+            count = other.count;
+        } else {
+            sync();
+        }
+        other.owned.clear();
+        other.sync();
+        return *this;
+    }
+
+    // Views count values at data, which must stay inside file
+    void Map(std::shared_ptr<const MappedFile> file, const T* data, size_t size) {
+        owned.clear();
+        owned.shrink_to_fit();
+        source = std::move(file);
+        first = data;
+        count = size;
+    }
+
+    const T& operator[](size_t i) const { return first[i]; }
+    const T* data() const { return first; }
+    const T* begin() const { return first; }
+    const T* end() const { return first + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    void push_back(const T& value) {
+        own();
+        owned.push_back(value);
+        sync();
+    }
+
+    void reserve(size_t capacity) {
+        own();
+        owned.reserve(capacity);
+        sync();
+    }
+};
+
+// Read-only view over a contiguous run of row indexes
+struct RowSpan {
+    const int* first = nullptr;
+    const int* last = nullptr;
+
+    RowSpan() = default;
+    RowSpan(const int* first, const int* last) : first(first), last(last) {}
+
+    const int* begin() const { return first; }
+    const int* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+    int operator[](size_t i) const { return first[i]; }
+};
+
+// Column-oriented storage for every loaded player. Each player is a row index; strings are interned once
+// and the per-row data is kept in contiguous columns so the optimizers only ever compare integers.
+struct PlayerTable {
+    // Positions are stored as a bitmask over position ids, so at most this many distinct positions are supported
+    static constexpr int kMaxPositions = 32;
+
+    StringPool names;
+    StringPool nations;
+    StringPool leagues;
+    StringPool clubs;
+    StringPool positions;
+
+    Column<int> nameIds;
+    Column<int> ratings;
+    Column<int> values;
+    Column<int> nationIds;
+    Column<int> leagueIds;
+    Column<int> clubIds;
+    Column<uint32_t> positionMasks;
+    Column<int> playerIds;      // player_id from the CSV, -1 if the file has none
+    Column<int> versions;       // fifa_version * 1000 + fifa_update, 0 if the file has none
+
+    // Dense id of the footballer behind each row, shared by every version of them. Rows without a player_id
+    // fall back to their name. Used for duplicate checks instead of comparing names.
+    std::vector<int> identityIds;
+    int identityCount = 0;
+    std::unordered_map<int64_t, int> identityIndex; // Identity key -> identity id, see identityKey
+
+    // The Position names are interned first, so their ids are the Position values. Any other position in
+    // the data gets an id after them.
+    PlayerTable() {
+        for (int p = 0; p < POSITION_COUNT; p++) positions.Intern(kPositionNames[p]);
+    }
+
+    // Appends a player and returns its row index
+    int AddPlayer(const std::string& name,
+                  const std::vector<std::string>& playerPositions,
+                  int rating,
+                  int value,
+                  const std::string& nation,
+                  const std::string& league,
+                  const std::string& team) {
+        uint32_t mask = 0;
+        for (const std::string& pos : playerPositions) {
+            int posId = positions.Intern(pos);
+            if (posId < kMaxPositions) mask |= (1u << posId);
+        }
+
+        int nameId = names.Intern(name);
+        int nationId = nations.Intern(nation);
+        int leagueId = leagues.Intern(league);
+        int clubId = clubs.Intern(team);
+        return AddRow(nameId, rating, value, nationId, leagueId, clubId, mask);
+    }
+
+    // Appends a player whose strings have already been interned into this table's pools
+    int AddRow(int nameId, int rating, int value, int nationId, int leagueId, int clubId, uint32_t positionMask,
+               int playerId = -1, int version = 0) {
+        identityIds.push_back(internIdentity(playerId, nameId));
+        playerIds.push_back(playerId);
+        versions.push_back(version);
+        nameIds.push_back(nameId);
+        ratings.push_back(rating);
+        values.push_back(value);
+        nationIds.push_back(nationId);
+        leagueIds.push_back(leagueId);
+        clubIds.push_back(clubId);
+        positionMasks.push_back(positionMask);
+        return static_cast<int>(nameIds.size()) - 1;
+    }
+
+    size_t Size() const { return nameIds.size(); }
+
+    // Recomputes identityIds from playerIds and nameIds, for tables whose columns were filled directly
+    void BuildIdentities() {
+        identityIndex.clear();
+        identityCount = 0;
+        identityIds.resize(Size());
+        for (size_t row = 0; row < Size(); row++) identityIds[row] = internIdentity(playerIds[row], nameIds[row]);
+    }
+
+    bool PlaysPosition(int row, int posId) const {
+        return posId >= 0 && posId < kMaxPositions && (positionMasks[row] & (1u << posId)) != 0;
+    }
+
+    std::string_view GetName(int row) const { return names.Get(nameIds[row]); }
+
+private:
+    // Rows with a player_id are keyed by it; the rest by name id, offset so the two can never collide
+    static int64_t identityKey(int playerId, int nameId) {
+        return playerId >= 0 ? static_cast<int64_t>(playerId) : (static_cast<int64_t>(1) << 32) + nameId;
+    }
+
+    int internIdentity(int playerId, int nameId) {
+        auto inserted = identityIndex.emplace(identityKey(playerId, nameId), identityCount);
+        if (inserted.second) identityCount++;
+        return inserted.first->second;
+    }
+};
+
+// Set of identity ids backed by a bitset, so duplicate checks are a single bit test
+class IdentitySet {
+private:
+    std::vector<uint64_t> words;
+
+public:
+    IdentitySet() = default;
+    explicit IdentitySet(int identityCount) : words((static_cast<size_t>(identityCount) + 63) / 64, 0) {}
+
+    bool Contains(int id) const { return (words[id >> 6] >> (id & 63)) & 1; }
+    void Insert(int id) { words[id >> 6] |= (uint64_t(1) << (id & 63)); }
+    void Erase(int id) { words[id >> 6] &= ~(uint64_t(1) << (id & 63)); }
+};
+
+#endif // PLAYER_TABLE_H
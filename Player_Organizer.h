@@ -1,6 +1,10 @@
 #ifndef PLAYER_ORGANIZER_H
 #define PLAYER_ORGANIZER_H
 
+#include "Formations.h"
+#include "PlayerTable.h"
+#include <algorithm>
+#include <array>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -28,41 +32,234 @@ struct Player {
           value(value), nation(nation), league(league), team(team) {}
 };
 
+// Rows returned by a filter. A query answered by a single index is a view straight into that index;
+// a query that needed an intersection owns the matching rows. Either way no Player is copied.
+class RowList {
+private:
+    std::vector<int> storage;
+    RowSpan rows;
+
+public:
+    RowList() = default;
+    explicit RowList(RowSpan view) : rows(view) {}
+    explicit RowList(std::vector<int> owned) : storage(std::move(owned)), rows(storage.data(), storage.data() + storage.size()) {}
+
+    // Moving a vector keeps its buffer, so the span stays valid; copying would not
+    RowList(RowList&& other) noexcept : storage(std::move(other.storage)), rows(other.rows) { other.rows = RowSpan(); }
+    RowList& operator=(RowList&& other) noexcept {
+        storage = std::move(other.storage);
+        rows = other.rows;
+        other.rows = RowSpan();
+        return *this;
+    }
+    RowList(const RowList&) = delete;
+    RowList& operator=(const RowList&) = delete;
+
+    const int* begin() const { return rows.begin(); }
+    const int* end() const { return rows.end(); }
+    size_t size() const { return rows.size(); }
+    bool empty() const { return rows.empty(); }
+    int operator[](size_t i) const { return rows[i]; }
+};
+
 class PlayerOrganizer {
 private:
-    std::vector<Player> players;
+    PlayerTable players;
 
-    // Optional: Indexes for fast filtering
-    std::unordered_multimap<std::string, size_t> nationIndex;
-    std::unordered_multimap<std::string, size_t> leagueIndex;
-    std::unordered_multimap<std::string, size_t> teamIndex;
-    std::unordered_multimap<std::string, size_t> valueIndex;
-    // Could add rating buckets or just filter linearly
+    // Posting lists: for each interned nation, league, club and position id, the rows that match it in
+    // increasing row order, so two lists can be intersected with a merge
+    std::vector<std::vector<int>> nationIndex;
+    std::vector<std::vector<int>> leagueIndex;
+    std::vector<std::vector<int>> teamIndex;
+    std::vector<std::vector<int>> positionIndex;
 
-    void indexPlayer(const Player& player, size_t idx);
+    // All rows ordered by value (cheapest first) and by rating (highest first), so a budget or rating
+    // floor is a prefix of one of them
+    std::vector<int> valueIndex;
+    std::vector<int> ratingIndex;
+
+    void indexPlayer(int row) {
+        auto addPosting = [row](std::vector<std::vector<int>>& index, int id) {
+            if (id >= static_cast<int>(index.size())) index.resize(id + 1);
+            index[id].push_back(row);
+        };
+        addPosting(nationIndex, players.nationIds[row]);
+        addPosting(leagueIndex, players.leagueIds[row]);
+        addPosting(teamIndex, players.clubIds[row]);
+        for (int posId = 0; posId < static_cast<int>(players.positions.Size()); posId++) {
+            if (players.PlaysPosition(row, posId)) addPosting(positionIndex, posId);
+        }
+    }
+
+    bool cheaper(int a, int b) const {
+        return players.values[a] != players.values[b] ? players.values[a] < players.values[b] : a < b;
+    }
+
+    bool higherRated(int a, int b) const {
+        return players.ratings[a] != players.ratings[b] ? players.ratings[a] > players.ratings[b] : a < b;
+    }
+
+    static RowSpan spanOf(const std::vector<int>& rows) {
+        return RowSpan(rows.data(), rows.data() + rows.size());
+    }
+
+    static RowSpan lookup(const std::vector<std::vector<int>>& index, const StringPool& pool, const std::string& name) {
+        int id = pool.Find(name);
+        if (id < 0 || id >= static_cast<int>(index.size())) return RowSpan();
+        return spanOf(index[id]);
+    }
+
+    // Keeps the rows of sorted that also appear in other. Both are in increasing row order; each probe
+    // gallops forward through other, so a short list against a long one costs O(short * log(long)).
+    static void intersectInto(std::vector<int>& sorted, RowSpan other) {
+        const int* cursor = other.begin();
+        size_t kept = 0;
+        for (int row : sorted) {
+            size_t step = 1;
+            const int* probe = cursor;
+            while (probe < other.end() && *probe < row) {
+                cursor = probe;
+                probe = (static_cast<size_t>(other.end() - probe) > step) ? probe + step : other.end();
+                step *= 2;
+            }
+            cursor = std::lower_bound(cursor, probe, row);
+            if (cursor == other.end()) break;
+            if (*cursor == row) sorted[kept++] = row;
+        }
+        sorted.resize(kept);
+    }
 
 public:
     PlayerOrganizer() = default;
 
+    // Takes ownership of a loaded table and builds every index over it
+    explicit PlayerOrganizer(PlayerTable table) : players(std::move(table)) {
+        for (int row = 0; row < static_cast<int>(players.Size()); row++) indexPlayer(row);
+
+        valueIndex.resize(players.Size());
+        for (size_t row = 0; row < players.Size(); row++) valueIndex[row] = static_cast<int>(row);
+        ratingIndex = valueIndex;
+        std::sort(valueIndex.begin(), valueIndex.end(), [this](int a, int b) { return cheaper(a, b); });
+        std::sort(ratingIndex.begin(), ratingIndex.end(), [this](int a, int b) { return higherRated(a, b); });
+    }
+
     // Add a player and update indexes
-    void AddPlayer(const Player& player);
+    void AddPlayer(const Player& player) {
+        int row = players.AddPlayer(player.name, player.positions, player.rating, player.value,
+                                    player.nation, player.league, player.team);
+        indexPlayer(row);
+        valueIndex.insert(std::upper_bound(valueIndex.begin(), valueIndex.end(), row,
+                                           [this](int a, int b) { return cheaper(a, b); }), row);
+        ratingIndex.insert(std::upper_bound(ratingIndex.begin(), ratingIndex.end(), row,
+                                            [this](int a, int b) { return higherRated(a, b); }), row);
+    }
 
     // Get all players
-    const std::vector<Player>& GetAllPlayers() const;
-
-    // Filtering functions
-    std::vector<Player> GetPlayersByRating(int minRating) const;
-    std::vector<Player> GetPlayersByValue(const std::string& value) const;
-    std::vector<Player> GetPlayersByNation(const std::string& nation) const;
-    std::vector<Player> GetPlayersByLeague(const std::string& league) const;
-    std::vector<Player> GetPlayersByTeam(const std::string& team) const;
-
-    // Combined filtering: returns players matching all non-empty filters and min rating
-    std::vector<Player> FilterPlayers(int minRating = 0,
-                                      int value = 0,
-                                      const std::string& nation = "",
-                                      const std::string& league = "",
-                                      const std::string& team = "") const;
+    const PlayerTable& GetAllPlayers() const { return players; }
+
+    // Rebuilds a full Player record for a row. Only meant for output, never for the search itself.
+    Player GetPlayer(int row) const {
+        std::vector<std::string> playerPositions;
+        for (int posId = 0; posId < static_cast<int>(players.positions.Size()); posId++) {
+            if (players.PlaysPosition(row, posId)) playerPositions.emplace_back(players.positions.Get(posId));
+        }
+        return Player(std::string(players.GetName(row)), playerPositions, players.ratings[row], players.values[row],
+                      std::string(players.nations.Get(players.nationIds[row])), std::string(players.leagues.Get(players.leagueIds[row])),
+                      std::string(players.clubs.Get(players.clubIds[row])));
+    }
+
+    // Filtering functions. Each returns a view into an index, valid until the next AddPlayer.
+    // Players rated at least minRating, highest rated first
+    RowSpan GetPlayersByRating(int minRating) const {
+        auto last = std::partition_point(ratingIndex.begin(), ratingIndex.end(),
+                                         [&](int row) { return players.ratings[row] >= minRating; });
+        return RowSpan(ratingIndex.data(), ratingIndex.data() + (last - ratingIndex.begin()));
+    }
+
+    // Players worth at most maxValue, cheapest first
+    RowSpan GetPlayersByValue(int maxValue) const {
+        auto last = std::partition_point(valueIndex.begin(), valueIndex.end(),
+                                         [&](int row) { return players.values[row] <= maxValue; });
+        return RowSpan(valueIndex.data(), valueIndex.data() + (last - valueIndex.begin()));
+    }
+
+    RowSpan GetPlayersByNation(const std::string& nation) const { return lookup(nationIndex, players.nations, nation); }
+    RowSpan GetPlayersByLeague(const std::string& league) const { return lookup(leagueIndex, players.leagues, league); }
+    RowSpan GetPlayersByTeam(const std::string& team) const { return lookup(teamIndex, players.clubs, team); }
+    RowSpan GetPlayersByPosition(const std::string& position) const { return lookup(positionIndex, players.positions, position); }
+    RowSpan GetPlayersByPosition(Position position) const {
+        return position < positionIndex.size() ? spanOf(positionIndex[position]) : RowSpan();
+    }
+
+    // Combined filtering: returns rows matching all non-empty filters and min rating, in increasing row order.
+    // value is a maximum value (0 means no limit). The posting lists of the string filters are intersected
+    // starting from the shortest; rating and value are then checked on the survivors.
+    RowList FilterPlayers(int minRating = 0,
+                          int value = 0,
+                          const std::string& nation = "",
+                          const std::string& league = "",
+                          const std::string& team = "",
+                          const std::string& position = "") const {
+        std::vector<RowSpan> lists;
+        if (!nation.empty()) lists.push_back(GetPlayersByNation(nation));
+        if (!league.empty()) lists.push_back(GetPlayersByLeague(league));
+        if (!team.empty()) lists.push_back(GetPlayersByTeam(team));
+        if (!position.empty()) lists.push_back(GetPlayersByPosition(position));
+
+        auto passes = [&](int row) {
+            return players.ratings[row] >= minRating && (value <= 0 || players.values[row] <= value);
+        };
+
+        if (lists.empty()) {
+            // Only range filters: scan the shorter of the two sorted prefixes
+            RowSpan byRating = GetPlayersByRating(minRating);
+            RowSpan byValue = value > 0 ? GetPlayersByValue(value) : RowSpan(valueIndex.data(), valueIndex.data() + valueIndex.size());
+            RowSpan driver = byRating.size() <= byValue.size() ? byRating : byValue;
+            std::vector<int> rows;
+            for (int row : driver) {
+                if (passes(row)) rows.push_back(row);
+            }
+            std::sort(rows.begin(), rows.end());
+            return RowList(std::move(rows));
+        }
+
+        std::sort(lists.begin(), lists.end(), [](const RowSpan& a, const RowSpan& b) { return a.size() < b.size(); });
+
+        bool rangeFiltered = minRating > 0 || value > 0;
+        if (lists.size() == 1 && !rangeFiltered) return RowList(lists[0]);
+
+        std::vector<int> rows;
+        for (int row : lists[0]) {
+            if (passes(row)) rows.push_back(row);
+        }
+        for (size_t i = 1; i < lists.size() && !rows.empty(); i++) intersectInto(rows, lists[i]);
+        return RowList(std::move(rows));
+    }
 };
 
+// Candidate rows for each position, indexed by Position. Lists for positions outside the formation stay empty.
+using PlayerByPosition = std::array<std::vector<int>, POSITION_COUNT>;
+
+// Build position-based lists. This makes A* much more efficient so that the program only loops through valid players for each position rather than all players.
+// Only the positions in the formation are built, and each one only touches the rows in that position's index.
+// Each list is sorted by value, most expensive first.
+inline PlayerByPosition BuildPlayerByPosition(const PlayerOrganizer& organizer, const Formation& formation, int minRating) {
+    const PlayerTable& table = organizer.GetAllPlayers();
+    PlayerByPosition playerByPosition;
+    uint32_t used = FormationPositionMask(formation);
+    for (int p = 0; p < POSITION_COUNT; p++) {
+        Position pos = static_cast<Position>(p);
+        if (!(used & PositionBit(pos))) continue;
+
+        std::vector<int>& vec = playerByPosition[pos];
+        for (int row : organizer.GetPlayersByPosition(pos)) {
+            if (table.ratings[row] >= minRating) vec.push_back(row);
+        }
+        std::stable_sort(vec.begin(), vec.end(), [&](int a, int b) {
+            return table.values[a] > table.values[b];
+        });
+    }
+    return playerByPosition;
+}
+
 #endif // PLAYER_ORGANIZER_H
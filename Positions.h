@@ -0,0 +1,52 @@
+#ifndef POSITIONS_H
+#define POSITIONS_H
+
+#include <cstdint>
+#include <string>
+
+// Every position a formation slot can ask for. A PlayerTable interns these names first and in this order
+// (see PlayerTable's constructor), so a Position is also the position id used by positionMasks.
+enum Position : uint8_t {
+    POS_GK,
+    POS_LB,
+    POS_LWB,
+    POS_CB,
+    POS_RB,
+    POS_RWB,
+    POS_CDM,
+    POS_CM,
+    POS_CAM,
+    POS_LM,
+    POS_RM,
+    POS_LAM,
+    POS_RAM,
+    POS_LW,
+    POS_RW,
+    POS_LF,
+    POS_RF,
+    POS_CF,
+    POS_ST,
+    POSITION_COUNT
+};
+
+constexpr const char* kPositionNames[POSITION_COUNT] = {
+    "GK", "LB", "LWB", "CB", "RB", "RWB", "CDM", "CM", "CAM", "LM", "RM", "LAM", "RAM", "LW", "RW", "LF", "RF", "CF", "ST"
+};
+
+constexpr const char* PositionName(Position position) { return kPositionNames[position]; }
+
+// Bit of position in PlayerTable::positionMasks
+constexpr uint32_t PositionBit(Position position) { return 1u << position; }
+
+// Parses a position name such as "CDM". Returns false if it is not one of the positions above.
+inline bool ParsePosition(const std::string& name, Position& position) {
+    for (int p = 0; p < POSITION_COUNT; p++) {
+        if (name == kPositionNames[p]) {
+            position = static_cast<Position>(p);
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif // POSITIONS_H
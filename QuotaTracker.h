@@ -0,0 +1,91 @@
+#ifndef QUOTA_TRACKER_H
+#define QUOTA_TRACKER_H
+
+#include "PlayerTable.h"
+#include "Requirements.h"
+#include <cstdint>
+#include <vector>
+
+/*
+  Decides early whether the nation, league and club quotas can still be met by the open slots of a partial
+  squad, so the optimizers drop a branch as soon as they cannot instead of finding out at the full squad.
+
+  For every quota the tracker records which formation slots have at least one eligible player from its group.
+  A player only has one nation, one league and one club, so quotas of the same kind compete for slots: with
+  England 2 and France 1 outstanding, three different open slots have to be fillable from those nations.
+  That is a bipartite matching between outstanding quota places and open slots, checked separately for each
+  kind. Quotas of different kinds can share a player (an English Premier League player counts for both), so
+  they are not matched against each other.
+*/
+class QuotaTracker {
+private:
+    static constexpr int kKinds = 3;
+
+    std::vector<QuotaGroup> quotas;
+    std::vector<uint32_t> eligibleSlots;   // [quota] bit s set if slot s has a player from the group
+    std::vector<int> quotasOfKind[kKinds]; // Quota indexes grouped by QuotaKind
+    int slotCount = 0;
+
+    // Kuhn's augmenting path from one quota place. slotOwner[s] is the quota place using slot s, or -1.
+    bool assign(int place, const int* placeQuota, uint32_t openSlots, uint32_t& visited, int* slotOwner) const {
+        uint32_t candidates = eligibleSlots[placeQuota[place]] & openSlots & ~visited;
+        for (int slot = 0; candidates; slot++, candidates >>= 1) {
+            if (!(candidates & 1)) continue;
+            visited |= (1u << slot);
+            if (slotOwner[slot] < 0 || assign(slotOwner[slot], placeQuota, openSlots, visited, slotOwner)) {
+                slotOwner[slot] = place;
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    QuotaTracker(const Formation& formation,
+                 const PlayerTable& table,
+                 const PlayerByPosition& playerByPosition,
+                 const std::vector<QuotaGroup>& quotas)
+        : quotas(quotas), eligibleSlots(quotas.size(), 0), slotCount(static_cast<int>(formation.size())) {
+        for (size_t g = 0; g < quotas.size(); g++) quotasOfKind[quotas[g].kind].push_back(static_cast<int>(g));
+
+        for (int slot = 0; slot < slotCount && slot < 32; slot++) {
+            for (size_t g = 0; g < quotas.size(); g++) {
+                for (int row : playerByPosition[formation[slot]]) {
+                    if (quotas[g].Contains(row, table)) {
+                        eligibleSlots[g] |= (1u << slot);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    const std::vector<QuotaGroup>& Quotas() const { return quotas; }
+
+    // True if slots positionIndex.. can still supply the outstanding[g] players every quota g needs
+    bool CanStillMeet(int positionIndex, const int* outstanding) const {
+        if (positionIndex >= 32) return true;
+        uint32_t openSlots = (slotCount >= 32 ? ~0u : ((1u << slotCount) - 1)) & ~((1u << positionIndex) - 1);
+        int openCount = slotCount - positionIndex;
+
+        for (int kind = 0; kind < kKinds; kind++) {
+            int placeQuota[32]; // One entry per outstanding player, holding its quota index
+            int places = 0;
+            for (int g : quotasOfKind[kind]) {
+                if (places + outstanding[g] > openCount) return false; // More players needed than slots left
+                for (int i = 0; i < outstanding[g]; i++) placeQuota[places++] = g;
+            }
+            if (places == 0) continue;
+
+            int slotOwner[32];
+            for (int& owner : slotOwner) owner = -1;
+            for (int place = 0; place < places; place++) {
+                uint32_t visited = 0;
+                if (!assign(place, placeQuota, openSlots, visited, slotOwner)) return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif // QUOTA_TRACKER_H
@@ -5,11 +5,10 @@
 #include <vector>
 #include <limits>
 #include <sstream>
-#include <unordered_map>
 #include <algorithm>
 #include "Formations.h"
-#include "Player_Organizer.h" // For Player struct
 #include "SquadHelper.h" //For helper functions
+#include "SearchProfile.h"
 
 struct SquadRequirements {
     std::string formation;
@@ -172,15 +171,12 @@ inline std::vector<int> getValidatedIntList(const std::string& prompt, size_t ex
 inline SquadRequirements Requirements() {
     SquadRequirements req;
 
-    Formations formations;
-
     // Formation input & validation
     while (true) {
         std::cout << "Enter your desired formation (e.g., 4-2-3-1):" << std::endl;
         getline(std::cin, req.formation);
 
-        auto posList = formations.getPositions(req.formation);
-        if (posList.size() == 1 && posList[0] == "Invalid formation") {
+        if (!FindFormation(req.formation)) {
             std::cout << "Invalid formation. Please enter a valid formation from the list." << std::endl;
             continue;
         }
@@ -237,59 +233,95 @@ inline SquadRequirements Requirements() {
     return req;
 }
 
-// Check if squad meets requirements
-inline bool DoesSquadMeetRequirements(const std::vector<Player>& squad, const SquadRequirements& req) {
-    // Must have exactly 11 players
-    if (squad.size() != 11) return false;
-
-    // Check formation length matches squad size
-    Formations formations;
-    auto formationPositions = formations.getPositions(req.formation);
-    if (formationPositions.size() != squad.size()) return false;
-
-    // Check total squad value <= maxBudget
-    int totalValue = calculateTotalSquadValue(squad);
-    if (totalValue > req.maxBudget) return false;
-
-    // Check average rating >= required minOverallRating
-    int avgRating = calculateAverageRating(squad);
-    if (avgRating < req.minOverallRating) return false;
-
-    // Check chemistry >= minTeamChemistry
-    int chem = calculateChem(squad);
-    if (chem < req.minTeamChemistry) return false;
-
-    // Check nations counts
-    std::unordered_map<std::string, int> nationCountMap;
-    for (const auto& player : squad) nationCountMap[player.nation]++;
+// Which column of the PlayerTable a quota is counted on
+enum QuotaKind {
+    QUOTA_NATION,
+    QUOTA_LEAGUE,
+    QUOTA_CLUB
+};
 
-    if (!req.nations.empty()) {
-        for (size_t i = 0; i < req.nations.size(); i++) {
-            if (nationCountMap[req.nations[i]] < req.nationCounts[i]) return false;
+// One nation, league or club quota from SquadRequirements with its name resolved to a PlayerTable id.
+// id is -1 when no loaded player belongs to the group, which makes the quota impossible to meet.
+struct QuotaGroup {
+    QuotaKind kind;
+    int id;
+    int count;
+
+    bool Contains(int row, const PlayerTable& table) const {
+        switch (kind) {
+            case QUOTA_NATION: return table.nationIds[row] == id;
+            case QUOTA_LEAGUE: return table.leagueIds[row] == id;
+            default: return table.clubIds[row] == id;
         }
     }
+};
 
-    // Check leagues counts
-    std::unordered_map<std::string, int> leagueCountMap;
-    for (const auto& player : squad) leagueCountMap[player.league]++;
-
-    if (!req.leagues.empty()) {
-        for (size_t i = 0; i < req.leagues.size(); i++) {
-            if (leagueCountMap[req.leagues[i]] < req.leagueCounts[i]) return false;
+// Resolves every nation, league and club quota of req against the table's string pools. A group named more
+// than once only has to reach its largest count (each entry is checked on its own), so repeats are merged.
+inline std::vector<QuotaGroup> resolveQuotas(const SquadRequirements& req, const PlayerTable& table) {
+    std::vector<QuotaGroup> quotas;
+    auto add = [&quotas](QuotaKind kind, int id, int count) {
+        for (QuotaGroup& quota : quotas) {
+            if (quota.kind == kind && quota.id == id && id >= 0) {
+                quota.count = std::max(quota.count, count);
+                return;
+            }
         }
-    }
+        quotas.push_back({kind, id, count});
+    };
+    for (size_t i = 0; i < req.nations.size(); i++) add(QUOTA_NATION, table.nations.Find(req.nations[i]), req.nationCounts[i]);
+    for (size_t i = 0; i < req.leagues.size(); i++) add(QUOTA_LEAGUE, table.leagues.Find(req.leagues[i]), req.leagueCounts[i]);
+    for (size_t i = 0; i < req.clubs.size(); i++) add(QUOTA_CLUB, table.clubs.Find(req.clubs[i]), req.clubCounts[i]);
+    return quotas;
+}
 
-    // Check clubs counts
-    std::unordered_map<std::string, int> clubCountMap;
-    for (const auto& player : squad) clubCountMap[player.team]++;
+// SquadRequirements compiled against a PlayerTable for the optimizers' goal test. The formation size is
+// looked up and the quota names are resolved to ids once, so a check is only integer sums and compares
+// over the squad's rows. A group named more than once only has to reach its largest count, as before.
+class RequirementChecker {
+private:
+    int slotCount;
+    int maxBudget;
+    int minRatingSum;  // Average rating >= minOverallRating, with the division done up front
+    int minChemistry;
+    std::vector<QuotaGroup> quotas;
+
+public:
+    RequirementChecker(const SquadRequirements& req, const PlayerTable& table, int formationSize)
+        : slotCount(formationSize),
+          maxBudget(req.maxBudget),
+          minRatingSum(req.minOverallRating * formationSize),
+          minChemistry(req.minTeamChemistry),
+          quotas(resolveQuotas(req, table)) {}
+
+    bool Check(const int* squad, int size, const PlayerTable& table) const {
+        PROFILE_TIME(TIME_REQUIREMENTS);
+        // Must have exactly 11 players, one per formation slot
+        if (size != 11 || size != slotCount) return false;
+
+        int value = 0, ratingSum = 0;
+        for (int i = 0; i < size; i++) {
+            value += table.values[squad[i]];
+            ratingSum += table.ratings[squad[i]];
+        }
+        if (value > maxBudget || ratingSum < minRatingSum) return false;
 
-    if (!req.clubs.empty()) {
-        for (size_t i = 0; i < req.clubs.size(); i++) {
-            if (clubCountMap[req.clubs[i]] < req.clubCounts[i]) return false;
+        for (const QuotaGroup& quota : quotas) {
+            int count = 0;
+            for (int i = 0; i < size; i++) {
+                if (quota.Contains(squad[i], table)) count++;
+            }
+            if (count < quota.count) return false;
         }
+
+        // Chemistry last, it is the only check that compares every pair of players
+        return minChemistry <= 0 || calculateChem(squad, size, table) >= minChemistry;
     }
-    return true;
-}
+
+    bool Check(const std::vector<int>& squad, const PlayerTable& table) const {
+        return Check(squad.data(), static_cast<int>(squad.size()), table);
+    }
+};
 
 #endif // REQUIREMENTS_H
 
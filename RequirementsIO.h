@@ -0,0 +1,303 @@
+#ifndef REQUIREMENTS_IO_H
+#define REQUIREMENTS_IO_H
+
+#include "Formations.h"
+#include "Requirements.h"
+#include <cctype>
+#include <climits>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+  Reads and writes SquadRequirements as one JSON object per line (JSON Lines), so requirements can come
+  from a file instead of the interactive prompts. The keys are the SquadRequirements field names:
+
+  {"formation": "4-3-3", "maxBudget": 2000000, "minOverallRating": 80, "minTeamChemistry": 0,
+   "nations": ["England"], "nationCounts": [1], "leagues": [], "leagueCounts": [], "clubs": [], "clubCounts": []}
+
+  The lists and their counts are optional. An "id" string can be added to name the request.
+*/
+
+// Minimal JSON reader covering what a requirements record needs: objects, arrays, strings and integers
+class JSONCursor {
+private:
+    const std::string& text;
+    size_t pos = 0;
+
+    // Reads the 4 hex digits of a \u escape
+    bool readHex4(unsigned& code) {
+        if (pos + 4 > text.size()) return false;
+        code = 0;
+        for (size_t end = pos + 4; pos < end; pos++) {
+            char c = text[pos];
+            if (!std::isxdigit(static_cast<unsigned char>(c))) return false;
+            code = code * 16 + static_cast<unsigned>(std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : std::tolower(c) - 'a' + 10);
+        }
+        return true;
+    }
+
+    static void appendUTF8(std::string& out, unsigned code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+public:
+    explicit JSONCursor(const std::string& text) : text(text) {}
+
+    void SkipSpace() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) pos++;
+    }
+
+    bool Consume(char c) {
+        SkipSpace();
+        if (pos < text.size() && text[pos] == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    bool AtEnd() {
+        SkipSpace();
+        return pos == text.size();
+    }
+
+    bool ReadString(std::string& out) {
+        if (!Consume('"')) return false;
+        out.clear();
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c == '\\') {
+                if (pos >= text.size()) return false;
+                char escaped = text[pos++];
+                switch (escaped) {
+                    case 'n': out += '\n'; break;
+                    case 't': out += '\t'; break;
+                    case 'r': out += '\r'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'u': {
+                        // Written out as UTF-8, the encoding the CSV names use. A surrogate pair is one code point;
+                        // a lone surrogate makes the string invalid.
+                        unsigned code;
+                        if (!readHex4(code)) return false;
+                        if (code >= 0xD800 && code <= 0xDBFF) {
+                            unsigned low;
+                            if (pos + 2 > text.size() || text[pos] != '\\' || text[pos + 1] != 'u') return false;
+                            pos += 2;
+                            if (!readHex4(low) || low < 0xDC00 || low > 0xDFFF) return false;
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        } else if (code >= 0xDC00 && code <= 0xDFFF) {
+                            return false;
+                        }
+                        appendUTF8(out, code);
+                        break;
+                    }
+                    default: out += escaped; break;
+                }
+            } else {
+                out += c;
+            }
+        }
+        return Consume('"');
+    }
+
+    bool ReadInt(int& out) {
+        SkipSpace();
+        size_t start = pos;
+        if (pos < text.size() && text[pos] == '-') pos++;
+        long long value = 0;
+        size_t digits = 0;
+        for (; pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos])); pos++, digits++) {
+            value = value * 10 + (text[pos] - '0');
+            if (value > INT_MAX) return false;
+        }
+        if (digits == 0) return false;
+        out = static_cast<int>(text[start] == '-' ? -value : value);
+        return true;
+    }
+
+    // Reads [item, item, ...] calling readItem for each element
+    template <typename ReadItem>
+    bool ReadArray(ReadItem readItem) {
+        if (!Consume('[')) return false;
+        if (Consume(']')) return true;
+        do {
+            if (!readItem()) return false;
+        } while (Consume(','));
+        return Consume(']');
+    }
+};
+
+inline bool readStringList(JSONCursor& json, std::vector<std::string>& out) {
+    out.clear();
+    return json.ReadArray([&]() {
+        std::string item;
+        if (!json.ReadString(item)) return false;
+        out.push_back(item);
+        return true;
+    });
+}
+
+inline bool readIntList(JSONCursor& json, std::vector<int>& out) {
+    out.clear();
+    return json.ReadArray([&]() {
+        int item;
+        if (!json.ReadInt(item)) return false;
+        out.push_back(item);
+        return true;
+    });
+}
+
+// Applies the same limits as the interactive prompts. Returns an empty string if req is valid.
+inline std::string ValidateRequirements(const SquadRequirements& req) {
+    if (!FindFormation(req.formation)) return "invalid formation " + req.formation;
+    if (req.maxBudget < 1) return "maxBudget must be at least 1";
+    if (req.minOverallRating < 0 || req.minOverallRating > 99) return "minOverallRating must be between 0 and 99";
+    if (req.minTeamChemistry < 0 || req.minTeamChemistry > 33) return "minTeamChemistry must be between 0 and 33";
+
+    auto checkCounts = [](const std::vector<std::string>& names, const std::vector<int>& counts, const std::string& what) -> std::string {
+        if (names.size() != counts.size()) return what + " and " + what + "Counts must have the same length";
+        int total = 0;
+        for (int count : counts) {
+            if (count < 1 || count > 11) return what + "Counts entries must be between 1 and 11";
+            total += count;
+        }
+        if (total > 11) return what + "Counts total exceeds 11";
+        return "";
+    };
+    std::string error = checkCounts(req.nations, req.nationCounts, "nations");
+    if (error.empty()) error = checkCounts(req.leagues, req.leagueCounts, "leagues");
+    if (error.empty()) error = checkCounts(req.clubs, req.clubCounts, "clubs");
+    return error;
+}
+
+// Parses one JSON Lines record into req (and its optional "id"). On failure returns false and sets error.
+inline bool ParseRequirementsJSON(const std::string& line, SquadRequirements& req, std::string& id, std::string& error) {
+    req = SquadRequirements();
+    req.maxBudget = 0;
+    req.minOverallRating = 0;
+    req.minTeamChemistry = 0;
+    id.clear();
+
+    JSONCursor json(line);
+    if (!json.Consume('{')) {
+        error = "expected a JSON object";
+        return false;
+    }
+
+    bool haveFormation = false, haveBudget = false;
+    if (!json.Consume('}')) {
+        do {
+            std::string key;
+            if (!json.ReadString(key) || !json.Consume(':')) {
+                error = "expected \"key\": value";
+                return false;
+            }
+
+            bool ok;
+            if (key == "id") ok = json.ReadString(id);
+            else if (key == "formation") ok = haveFormation = json.ReadString(req.formation);
+            else if (key == "maxBudget") ok = haveBudget = json.ReadInt(req.maxBudget);
+            else if (key == "minOverallRating") ok = json.ReadInt(req.minOverallRating);
+            else if (key == "minTeamChemistry") ok = json.ReadInt(req.minTeamChemistry);
+            else if (key == "nations") ok = readStringList(json, req.nations);
+            else if (key == "nationCounts") ok = readIntList(json, req.nationCounts);
+            else if (key == "leagues") ok = readStringList(json, req.leagues);
+            else if (key == "leagueCounts") ok = readIntList(json, req.leagueCounts);
+            else if (key == "clubs") ok = readStringList(json, req.clubs);
+            else if (key == "clubCounts") ok = readIntList(json, req.clubCounts);
+            else {
+                error = "unknown key " + key;
+                return false;
+            }
+            if (!ok) {
+                error = "bad value for " + key;
+                return false;
+            }
+        } while (json.Consume(','));
+
+        if (!json.Consume('}')) {
+            error = "expected , or }";
+            return false;
+        }
+    }
+    if (!json.AtEnd()) {
+        error = "unexpected text after the object";
+        return false;
+    }
+    if (!haveFormation || !haveBudget) {
+        error = "formation and maxBudget are required";
+        return false;
+    }
+
+    error = ValidateRequirements(req);
+    return error.empty();
+}
+
+// Escapes a string for use inside a JSON string literal
+inline std::string jsonEscape(std::string_view str) {
+    std::string out;
+    for (char c : str) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            case '\r': out += "\\r"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+// Writes req as a single-line JSON object that ParseRequirementsJSON reads back
+inline std::string RequirementsToJSON(const SquadRequirements& req, const std::string& id = "") {
+    auto strings = [](const std::vector<std::string>& list) {
+        std::string out = "[";
+        for (size_t i = 0; i < list.size(); i++) out += (i ? ", \"" : "\"") + jsonEscape(list[i]) + "\"";
+        return out + "]";
+    };
+    auto ints = [](const std::vector<int>& list) {
+        std::string out = "[";
+        for (size_t i = 0; i < list.size(); i++) out += (i ? ", " : "") + std::to_string(list[i]);
+        return out + "]";
+    };
+
+    std::ostringstream out;
+    out << "{";
+    if (!id.empty()) out << "\"id\": \"" << jsonEscape(id) << "\", ";
+    out << "\"formation\": \"" << jsonEscape(req.formation) << "\", "
+        << "\"maxBudget\": " << req.maxBudget << ", "
+        << "\"minOverallRating\": " << req.minOverallRating << ", "
+        << "\"minTeamChemistry\": " << req.minTeamChemistry << ", "
+        << "\"nations\": " << strings(req.nations) << ", \"nationCounts\": " << ints(req.nationCounts) << ", "
+        << "\"leagues\": " << strings(req.leagues) << ", \"leagueCounts\": " << ints(req.leagueCounts) << ", "
+        << "\"clubs\": " << strings(req.clubs) << ", \"clubCounts\": " << ints(req.clubCounts) << "}";
+    return out.str();
+}
+
+#endif // REQUIREMENTS_IO_H
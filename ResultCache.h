@@ -0,0 +1,271 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "Formations.h"
+#include "LocalSearch.h"
+#include "PlayerTable.h"
+#include "Requirements.h"
+#include "RequirementsIO.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+  Remembers solved requirements so a repeated request is answered without searching.
+
+  Requests are keyed by a canonical form of their requirements, so cosmetic differences hit the same entry:
+  - the formation becomes its sorted list of positions, so formations with the same positions ("4-4-2" and
+    "4-4-2 Flat", or "4-2-3-1" and "4-2-3-1 Wide") share results. Squads are stored in that sorted order
+    and handed back in the slot order of the formation that was asked for.
+  - quotas are merged by name (largest count wins), quotas of 0 are dropped and the rest are sorted by name
+  The key also holds the algorithm, since A* and Best Fit give different squads, and a fingerprint of the
+  loaded players. Squads are stored as row indexes, and any change to the player data changes the
+  fingerprint, so stale entries are never returned.
+
+  Entries live in an LRU list in memory. With a path, every new entry is also appended to that file. When
+  the cache is created, the entries in the file that match the current fingerprint are loaded, and the
+  file is rewritten without the others.
+*/
+
+// 64-bit FNV-1a over the player data and string pools. Changes whenever anything the optimizers read changes.
+inline uint64_t DatasetFingerprint(const PlayerTable& table) {
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](const void* data, size_t bytes) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; i++) {
+            hash ^= p[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    auto mixColumn = [&mix](const auto& column) {
+        uint64_t size = column.size();
+        mix(&size, sizeof(size));
+        if (!column.empty()) mix(column.data(), column.size() * sizeof(column[0]));
+    };
+    auto mixPool = [&mix](const StringPool& pool) {
+        uint64_t size = pool.Size();
+        mix(&size, sizeof(size));
+        const char terminator = 0;
+        for (size_t id = 0; id < pool.Size(); id++) {
+            std::string_view str = pool.Get(static_cast<int>(id));
+            mix(str.data(), str.size());
+            mix(&terminator, 1);
+        }
+    };
+
+    mixPool(table.names);
+    mixPool(table.nations);
+    mixPool(table.leagues);
+    mixPool(table.clubs);
+    mixPool(table.positions);
+    mixColumn(table.nameIds);
+    mixColumn(table.ratings);
+    mixColumn(table.values);
+    mixColumn(table.nationIds);
+    mixColumn(table.leagueIds);
+    mixColumn(table.clubIds);
+    mixColumn(table.positionMasks);
+    mixColumn(table.playerIds);
+    mixColumn(table.versions);
+    return hash;
+}
+
+// Moves the players of squad, laid out for the slots of from, into the slots of to. Both formations must
+// hold the same positions; each slot of to takes the next unused player of a from slot with its position.
+inline std::vector<int> reorderSquad(const std::vector<int>& squad, const Formation& from, const Formation& to) {
+    std::vector<int> reordered(to.size(), -1);
+    bool taken[kSquadSize] = {};
+    for (size_t slot = 0; slot < to.size(); slot++) {
+        for (size_t source = 0; source < from.size(); source++) {
+            if (taken[source] || from[source] != to[slot]) continue;
+            taken[source] = true;
+            reordered[slot] = squad[source];
+            break;
+        }
+    }
+    return reordered;
+}
+
+// Cache label of a solver setup. Every optimal A* run (single thread, parallel or an exhausted anytime run)
+// shares "astar"; Best Fit with annealing includes every option that changes the squad it ends on.
+inline std::string SolverLabel(bool useAStar, bool useLocalSearch, const LocalSearchOptions& localSearch) {
+    if (useAStar) return "astar";
+    if (!useLocalSearch) return "bestfit";
+    int restarts = std::max(1, localSearch.restarts);
+    std::ostringstream label;
+    label << "bestfit+sa:" << restarts << "," << localSearch.iterations << "," << localSearch.movesPerCandidate << ","
+          << localSearch.minIterations << "," << localSearch.maxIterations << "," << localSearch.stallIterations << ","
+          << localSearch.startTemperature << "," << localSearch.endTemperature << "," << localSearch.swapProbability << ","
+          << localSearch.seed;
+    return label.str();
+}
+
+class ResultCache {
+private:
+    using Entry = std::pair<std::string, std::vector<int>>; // Key, squad in canonical slot order (empty if none)
+
+    std::string fingerprint; // Hex form of DatasetFingerprint, the first part of every key
+    size_t capacity;
+    std::string path;
+
+    std::mutex mutex;
+    std::list<Entry> entries; // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    long long hits = 0;
+    long long misses = 0;
+
+    static Formation canonicalFormation(const Formation& formation) {
+        Formation sorted = formation;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted;
+    }
+
+    static std::string canonicalQuotas(const std::vector<std::string>& names, const std::vector<int>& counts) {
+        std::map<std::string, int> merged; // Sorted by name
+        for (size_t i = 0; i < names.size() && i < counts.size(); i++) {
+            if (counts[i] <= 0) continue;
+            int& count = merged[names[i]];
+            count = std::max(count, counts[i]);
+        }
+        std::string out = "[";
+        for (const auto& quota : merged) out += "\"" + jsonEscape(quota.first) + "\":" + std::to_string(quota.second) + ",";
+        return out + "]";
+    }
+
+    std::string keyFor(const std::string& algorithm, const SquadRequirements& req, const Formation& formation) const {
+        std::string key = fingerprint + " " + algorithm + " ";
+        for (Position position : canonicalFormation(formation)) key += std::string(PositionName(position)) + ",";
+        key += " b" + std::to_string(req.maxBudget) + " r" + std::to_string(req.minOverallRating) +
+               " c" + std::to_string(req.minTeamChemistry);
+        key += " n" + canonicalQuotas(req.nations, req.nationCounts);
+        key += " l" + canonicalQuotas(req.leagues, req.leagueCounts);
+        key += " t" + canonicalQuotas(req.clubs, req.clubCounts);
+        return key;
+    }
+
+    // Adds or refreshes an entry and evicts the least recently used one when full. Caller holds the mutex.
+    void insert(const std::string& key, const std::vector<int>& squad) {
+        auto it = index.find(key);
+        if (it != index.end()) entries.erase(it->second);
+        entries.emplace_front(key, squad);
+        index[key] = entries.begin();
+        while (entries.size() > capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+
+    static std::string lineFor(const std::string& key, const std::vector<int>& squad) {
+        std::string line = key + "\t" + std::to_string(squad.size());
+        for (int row : squad) line += " " + std::to_string(row);
+        return line;
+    }
+
+    // Loads the entries of the file written for the same player data, then rewrites the file if it held
+    // entries for other data
+    void load(size_t rowCount) {
+        std::ifstream in(path);
+        if (!in.is_open()) return;
+
+        std::vector<std::string> kept;
+        bool stale = false;
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t tab = line.find('\t');
+            if (tab == std::string::npos || line.compare(0, fingerprint.size() + 1, fingerprint + " ") != 0) {
+                stale = true;
+                continue;
+            }
+            std::istringstream rows(line.substr(tab + 1));
+            size_t count = 0;
+            std::vector<int> squad;
+            int row;
+            bool valid = static_cast<bool>(rows >> count) && (count == 0 || count == kSquadSize);
+            while (valid && squad.size() < count && rows >> row) {
+                valid = row >= 0 && static_cast<size_t>(row) < rowCount;
+                squad.push_back(row);
+            }
+            if (!valid || squad.size() != count) {
+                stale = true;
+                continue;
+            }
+            insert(line.substr(0, tab), squad);
+            kept.push_back(line);
+        }
+        in.close();
+
+        if (stale) {
+            std::ofstream out(path, std::ios::trunc);
+            for (const std::string& keptLine : kept) out << keptLine << "\n";
+        }
+    }
+
+public:
+    // path may be empty to keep the cache in memory only
+    ResultCache(const PlayerTable& table, size_t capacity = 4096, const std::string& path = "")
+        : capacity(std::max<size_t>(1, capacity)), path(path) {
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(DatasetFingerprint(table)));
+        fingerprint = hex;
+        if (!path.empty()) load(table.Size());
+    }
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    // Looks up the squad algorithm found for req. Returns false on a miss. On a hit squad is in the slot
+    // order of req.formation, or empty if no valid squad was found for it.
+    bool Get(const std::string& algorithm, const SquadRequirements& req, std::vector<int>& squad) {
+        const Formation* formation = FindFormation(req.formation);
+        if (!formation) return false;
+        std::string key = keyFor(algorithm, req, *formation);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            misses++;
+            return false;
+        }
+        hits++;
+        entries.splice(entries.begin(), entries, it->second);
+        const std::vector<int>& stored = it->second->second;
+        squad = stored.empty() ? stored : reorderSquad(stored, canonicalFormation(*formation), *formation);
+        return true;
+    }
+
+    // Stores the squad (in the slot order of req.formation, empty if none was found) for algorithm and req
+    void Put(const std::string& algorithm, const SquadRequirements& req, const std::vector<int>& squad) {
+        const Formation* formation = FindFormation(req.formation);
+        if (!formation || (!squad.empty() && squad.size() != formation->size())) return;
+        std::string key = keyFor(algorithm, req, *formation);
+        std::vector<int> stored = squad.empty() ? squad : reorderSquad(squad, *formation, canonicalFormation(*formation));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        insert(key, stored);
+        if (!path.empty()) {
+            std::ofstream out(path, std::ios::app);
+            out << lineFor(key, stored) << "\n";
+        }
+    }
+
+    long long Hits() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return hits;
+    }
+
+    long long Misses() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return misses;
+    }
+};
+
+#endif // RESULT_CACHE_H
@@ -0,0 +1,132 @@
+#ifndef SEARCH_PROFILE_H
+#define SEARCH_PROFILE_H
+
+#include <chrono>
+#include <sstream>
+#include <string>
+
+/*
+  Optional counters and timers that show where a search spends its time and which pruning rules fire.
+
+  Built with -DSQUAD_PROFILE (the SQUAD_PROFILE CMake option), the PROFILE_COUNT and PROFILE_TIME macros in
+  the optimizers add to the SearchProfile attached to the current thread. Without it the macros expand to
+  nothing, so the default build runs exactly the same code as before.
+
+  An optimizer attaches a profile with PROFILE_SCOPE when the caller passes it a SearchStats. Every thread of
+  a parallel search fills its own profile, and they are merged when the threads finish.
+*/
+
+enum ProfileCounter {
+    PRUNE_SYMMETRY,  // Same-position slot would take a lower row than the slot before it (A*)
+    PRUNE_DUPLICATE, // Another version of the footballer is already in the squad
+    PRUNE_BUDGET,    // Cost so far plus the player is over the budget
+    PRUNE_RATING,    // Projected rating can no longer reach the minimum (A*)
+    PRUNE_CHEMISTRY, // maxPossibleChem can no longer reach the minimum (A*), or the last player misses it (Best Fit)
+    PRUNE_QUOTA,     // Open slots can no longer cover the quotas
+    PRUNE_HEURISTIC, // Cost plus the lower bound for the open slots is over the budget (A*)
+    PRUNE_INCUMBENT, // Node cannot beat the best squad already found (parallel and anytime A*)
+    PRUNE_TRIED_CAP, // Best Fit gave up on a slot after 250 candidates
+    PROFILE_COUNTER_COUNT
+};
+
+enum ProfileTimer {
+    TIME_CANDIDATES,   // Sorting the per-position lists and streaming candidates in score order
+    TIME_CHEMISTRY,    // calculateChem and the chemistry projections of an expansion
+    TIME_HEURISTIC,    // Building the heuristic table and HeuristicTable::Estimate
+    TIME_REQUIREMENTS, // RequirementChecker::Check on full squads
+    PROFILE_TIMER_COUNT
+};
+
+inline const char* ProfileCounterName(ProfileCounter counter) {
+    static const char* const names[PROFILE_COUNTER_COUNT] = {
+        "symmetry", "duplicate", "budget", "rating", "chemistry", "quota", "heuristic", "incumbent", "triedCap"};
+    return names[counter];
+}
+
+inline const char* ProfileTimerName(ProfileTimer timer) {
+    static const char* const names[PROFILE_TIMER_COUNT] = {"candidates", "chemistry", "heuristic", "requirements"};
+    return names[timer];
+}
+
+struct SearchProfile {
+    long long counters[PROFILE_COUNTER_COUNT] = {};
+    long long timerCalls[PROFILE_TIMER_COUNT] = {};
+    long long timerNanos[PROFILE_TIMER_COUNT] = {};
+
+    void Merge(const SearchProfile& other) {
+        for (int i = 0; i < PROFILE_COUNTER_COUNT; i++) counters[i] += other.counters[i];
+        for (int i = 0; i < PROFILE_TIMER_COUNT; i++) {
+            timerCalls[i] += other.timerCalls[i];
+            timerNanos[i] += other.timerNanos[i];
+        }
+    }
+
+    // {"pruned": {"budget": 12, ...}, "timers": {"candidates": {"calls": 3, "ms": 0.1}, ...}}
+    std::string ToJSON() const {
+        std::ostringstream out;
+        out << "{\"pruned\": {";
+        for (int i = 0; i < PROFILE_COUNTER_COUNT; i++) {
+            out << (i ? ", " : "") << "\"" << ProfileCounterName(static_cast<ProfileCounter>(i)) << "\": " << counters[i];
+        }
+        out << "}, \"timers\": {";
+        for (int i = 0; i < PROFILE_TIMER_COUNT; i++) {
+            out << (i ? ", " : "") << "\"" << ProfileTimerName(static_cast<ProfileTimer>(i)) << "\": {\"calls\": "
+                << timerCalls[i] << ", \"ms\": " << timerNanos[i] / 1e6 << "}";
+        }
+        out << "}}";
+        return out.str();
+    }
+};
+
+// Profile the current thread reports to, nullptr when nobody is listening
+inline SearchProfile*& CurrentProfile() {
+    static thread_local SearchProfile* profile = nullptr;
+    return profile;
+}
+
+// Attaches profile to the current thread until the end of the scope
+class ProfileScope {
+private:
+    SearchProfile* previous;
+
+public:
+    explicit ProfileScope(SearchProfile* profile) : previous(CurrentProfile()) { CurrentProfile() = profile; }
+    ~ProfileScope() { CurrentProfile() = previous; }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+// Adds the time until the end of the scope to timer. The clock is only read when a profile is attached.
+class ScopedProfileTimer {
+private:
+    SearchProfile* profile;
+    ProfileTimer timer;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedProfileTimer(ProfileTimer timer) : profile(CurrentProfile()), timer(timer) {
+        if (profile) start = std::chrono::steady_clock::now();
+    }
+    ~ScopedProfileTimer() {
+        if (!profile) return;
+        profile->timerCalls[timer]++;
+        profile->timerNanos[timer] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+    ScopedProfileTimer(const ScopedProfileTimer&) = delete;
+    ScopedProfileTimer& operator=(const ScopedProfileTimer&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef SQUAD_PROFILE
+#define PROFILE_COUNT(counter) do { if (SearchProfile* profile_ = CurrentProfile()) profile_->counters[counter]++; } while (0)
+#define PROFILE_TIME(timer) ScopedProfileTimer PROFILE_CONCAT(profileTimer_, __LINE__)(timer)
+#define PROFILE_SCOPE(profile) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(profile)
+#else
+#define PROFILE_COUNT(counter) ((void)0)
+#define PROFILE_TIME(timer) ((void)0)
+#define PROFILE_SCOPE(profile) ((void)0)
+#endif
+
+#endif // SEARCH_PROFILE_H
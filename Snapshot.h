@@ -0,0 +1,321 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "CSVLoader.h"
+#include "MappedFile.h"
+#include "PlayerTable.h"
+#include "VersionPolicy.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+/*
+  Binary snapshot of a loaded PlayerTable so later runs can skip parsing the CSV.
+
+  Layout (native byte order, every section 4-byte aligned):
+  - SnapshotHeader
+  - 5 string dictionaries (names, nations, leagues, clubs, positions), each stored as
+    uint32 count, uint32 offsets[count + 1], then the characters padded to 4 bytes
+  - the row columns: nameIds, ratings, values, nationIds, leagueIds, clubIds, positionMasks, playerIds, versions
+
+  Each version policy has its own snapshot holding only the rows it keeps. identityIds are not stored; they
+  are rebuilt from playerIds and nameIds on load.
+
+  Loading does not copy the snapshot: the string pools and the columns of the table view the mapped file,
+  which stays mapped for as long as any of them refers to it.
+
+  The snapshot is a cache that belongs to one machine, so it is not meant to be portable between platforms.
+*/
+
+static const char kSnapshotMagic[8] = {'S', 'Q', 'U', 'A', 'D', 'S', 'N', 'P'};
+static const uint32_t kSnapshotVersion = 4;
+
+// Identifies the CSV a snapshot was built from. Any change in size or modification time means a rebuild.
+struct CSVStamp {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t poolCount;
+    uint32_t versionPolicy;
+    uint32_t reserved;
+    uint64_t csvSize;
+    int64_t csvMtime;
+    uint64_t rowCount;
+};
+
+inline bool GetCSVStamp(const std::string& csvPath, CSVStamp& stamp) {
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(csvPath, ec);
+    if (ec) return false;
+    auto mtime = std::filesystem::last_write_time(csvPath, ec);
+    if (ec) return false;
+
+    stamp.size = size;
+    stamp.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    return true;
+}
+
+inline std::string SnapshotPathFor(const std::string& csvPath, VersionPolicy policy = VERSIONS_ALL) {
+    if (policy == VERSIONS_ALL) return csvPath + ".snap";
+    return csvPath + "." + VersionPolicyName(policy) + ".snap";
+}
+
+// Appends raw bytes to the output buffer, padding to keep the next section 4-byte aligned
+inline void appendBytes(std::vector<char>& out, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+    while (out.size() % 4 != 0) out.push_back(0);
+}
+
+template <typename ColumnType>
+void appendColumn(std::vector<char>& out, const ColumnType& column) {
+    appendBytes(out, column.data(), column.size() * sizeof(typename ColumnType::value_type));
+}
+
+inline void appendPool(std::vector<char>& out, const StringPool& pool) {
+    uint32_t count = static_cast<uint32_t>(pool.Size());
+    std::vector<uint32_t> offsets(count + 1, 0);
+    std::string chars;
+    for (uint32_t id = 0; id < count; id++) {
+        chars += pool.Get(static_cast<int>(id));
+        offsets[id + 1] = static_cast<uint32_t>(chars.size());
+    }
+    appendBytes(out, &count, sizeof(count));
+    appendColumn(out, offsets);
+    appendBytes(out, chars.data(), chars.size());
+}
+
+// Name for a temporary file next to path that no other process writing the same snapshot will pick.
+// The pid keeps two runs on one machine apart and the random part covers systems without one.
+inline std::string snapshotTempPath(const std::string& path) {
+#ifndef _WIN32
+    unsigned long pid = static_cast<unsigned long>(::getpid());
+#else
+    unsigned long pid = static_cast<unsigned long>(::_getpid());
+#endif
+    std::random_device random;
+    std::ostringstream name;
+    name << path << ".tmp." << pid << "." << std::hex << random() << random();
+    return name.str();
+}
+
+// Writes the table to path. The file is written under a unique name next to its final one and renamed into
+// place, so a crash part way through never leaves a truncated snapshot behind, and two processes building
+// the same snapshot at once each rename a complete file of their own.
+inline bool WriteSnapshot(const std::string& path, const PlayerTable& table, const CSVStamp& stamp,
+                          VersionPolicy policy = VERSIONS_ALL) {
+    SnapshotHeader header;
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.poolCount = 5;
+    header.versionPolicy = static_cast<uint32_t>(policy);
+    header.reserved = 0;
+    header.csvSize = stamp.size;
+    header.csvMtime = stamp.mtime;
+    header.rowCount = table.Size();
+
+    std::vector<char> out;
+    appendBytes(out, &header, sizeof(header));
+    appendPool(out, table.names);
+    appendPool(out, table.nations);
+    appendPool(out, table.leagues);
+    appendPool(out, table.clubs);
+    appendPool(out, table.positions);
+    appendColumn(out, table.nameIds);
+    appendColumn(out, table.ratings);
+    appendColumn(out, table.values);
+    appendColumn(out, table.nationIds);
+    appendColumn(out, table.leagueIds);
+    appendColumn(out, table.clubIds);
+    appendColumn(out, table.positionMasks);
+    appendColumn(out, table.playerIds);
+    appendColumn(out, table.versions);
+
+    std::string tempPath = snapshotTempPath(path);
+    std::error_code ec;
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!file) {
+            file.close();
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+// Bounds-checked cursor over a mapped snapshot. Every read fails instead of running past the end of the file.
+// Pools and columns are pointed at the file rather than copied out of it.
+class SnapshotReader {
+private:
+    std::shared_ptr<const MappedFile> file;
+    const char* data;
+    size_t size;
+    size_t offset = 0;
+
+public:
+    explicit SnapshotReader(std::shared_ptr<const MappedFile> file)
+        : file(file), data(file->Data()), size(file->Size()) {}
+
+    bool ReadBytes(const char*& out, size_t bytes) {
+        size_t padded = (bytes + 3) & ~static_cast<size_t>(3);
+        if (padded < bytes || offset + padded > size || offset + padded < offset) return false;
+        out = data + offset;
+        offset += padded;
+        return true;
+    }
+
+    // Points out at the next count values of type T
+    template <typename T>
+    bool ReadArray(const T*& out, size_t count) {
+        const char* bytes;
+        if (count > size / sizeof(T) || !ReadBytes(bytes, count * sizeof(T))) return false;
+        if (reinterpret_cast<uintptr_t>(bytes) % alignof(T) != 0) return false;
+        out = reinterpret_cast<const T*>(bytes);
+        return true;
+    }
+
+    template <typename T>
+    bool ReadColumn(Column<T>& column, size_t count) {
+        const T* values;
+        if (!ReadArray(values, count)) return false;
+        column.Map(file, values, count);
+        return true;
+    }
+
+    // The offsets are checked here, but the strings themselves are only hashed if the pool is ever searched,
+    // so a snapshot with a repeated string is not caught on load. WriteSnapshot never produces one.
+    bool ReadPool(StringPool& pool) {
+        const uint32_t* count;
+        if (!ReadArray(count, 1)) return false;
+        const uint32_t* offsets;
+        if (!ReadArray(offsets, static_cast<size_t>(*count) + 1)) return false;
+        const char* chars;
+        if (offsets[0] != 0 || !ReadBytes(chars, offsets[*count])) return false;
+        for (uint32_t id = 0; id < *count; id++) {
+            if (offsets[id] > offsets[id + 1]) return false;
+        }
+        pool.Map(file, offsets, chars, *count);
+        return true;
+    }
+
+    bool AtEnd() const { return offset == size; }
+};
+
+// Checks that every stored id points into its dictionary, so a damaged snapshot can never index out of range
+inline bool validateSnapshotTable(const PlayerTable& table) {
+    auto inRange = [](const Column<int>& column, size_t limit) {
+        for (int id : column) {
+            if (id < 0 || static_cast<size_t>(id) >= limit) return false;
+        }
+        return true;
+    };
+    if (!inRange(table.nameIds, table.names.Size()) || !inRange(table.nationIds, table.nations.Size()) ||
+        !inRange(table.leagueIds, table.leagues.Size()) || !inRange(table.clubIds, table.clubs.Size())) return false;
+    for (int playerId : table.playerIds) {
+        if (playerId < -1) return false;
+    }
+    return true;
+}
+
+// Maps the snapshot at path into table. Returns false if it is missing, damaged, from another version or
+// version policy, or was built from a CSV with a different size or modification time.
+inline bool LoadSnapshot(const std::string& path, PlayerTable& table, const CSVStamp& stamp,
+                         VersionPolicy policy = VERSIONS_ALL) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(path, false) || file->Size() < sizeof(SnapshotHeader)) return false;
+
+    SnapshotHeader header;
+    std::memcpy(&header, file->Data(), sizeof(header));
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0) return false;
+    if (header.version != kSnapshotVersion || header.poolCount != 5) return false;
+    if (header.versionPolicy != static_cast<uint32_t>(policy)) return false;
+    if (header.csvSize != stamp.size || header.csvMtime != stamp.mtime) return false;
+
+    SnapshotReader reader(file);
+    const char* skip;
+    reader.ReadBytes(skip, sizeof(SnapshotHeader));
+
+    PlayerTable loaded;
+    size_t rows = static_cast<size_t>(header.rowCount);
+    if (!reader.ReadPool(loaded.names) || !reader.ReadPool(loaded.nations) || !reader.ReadPool(loaded.leagues) ||
+        !reader.ReadPool(loaded.clubs) || !reader.ReadPool(loaded.positions)) return false;
+    if (loaded.positions.Size() < POSITION_COUNT) return false;
+    for (int p = 0; p < POSITION_COUNT; p++) {
+        if (loaded.positions.Get(p) != kPositionNames[p]) return false; // Position ids must match the enum
+    }
+
+    if (!reader.ReadColumn(loaded.nameIds, rows) || !reader.ReadColumn(loaded.ratings, rows) ||
+        !reader.ReadColumn(loaded.values, rows) || !reader.ReadColumn(loaded.nationIds, rows) ||
+        !reader.ReadColumn(loaded.leagueIds, rows) || !reader.ReadColumn(loaded.clubIds, rows) ||
+        !reader.ReadColumn(loaded.positionMasks, rows) || !reader.ReadColumn(loaded.playerIds, rows) ||
+        !reader.ReadColumn(loaded.versions, rows)) return false;
+
+    if (!reader.AtEnd() || !validateSnapshotTable(loaded)) return false;
+
+    loaded.BuildIdentities();
+    table = std::move(loaded);
+    return true;
+}
+
+// Loads the players for csvPath, keeping the versions chosen by policy. Uses the policy's snapshot when it
+// is up to date. Otherwise the CSV is parsed, the policy applied and a fresh snapshot is written for the
+// next run.
+//
+// With a filter only the rows it keeps end up in table. An up-to-date snapshot is still used and filtered
+// after mapping. Without one and with VERSIONS_ALL, the filter is pushed into the CSV parse so skipped rows
+// are never stored, and no snapshot is written since it would only hold part of the file. Other policies
+// have to see every version of a footballer to pick one, so they parse everything, write the snapshot and
+// filter afterwards.
+inline bool LoadPlayers(const std::string& csvPath, PlayerTable& table, VersionPolicy policy = VERSIONS_ALL,
+                        const LoadFilter& filter = LoadFilter()) {
+    CSVStamp stamp;
+    bool haveStamp = GetCSVStamp(csvPath, stamp);
+    std::string snapshotPath = SnapshotPathFor(csvPath, policy);
+
+    if (haveStamp && LoadSnapshot(snapshotPath, table, stamp, policy)) {
+        ApplyLoadFilter(table, filter);
+        return true;
+    }
+
+    if (!filter.KeepsAll() && policy == VERSIONS_ALL) {
+        return LoadPlayersCSV(csvPath, table, 0, filter);
+    }
+
+    if (!LoadPlayersCSV(csvPath, table)) return false;
+    ApplyVersionPolicy(table, policy);
+
+    if (haveStamp && !WriteSnapshot(snapshotPath, table, stamp, policy)) {
+        std::cerr << "Warning: could not write player snapshot to " << snapshotPath << "\n";
+    }
+    ApplyLoadFilter(table, filter);
+    return true;
+}
+
+#endif // SNAPSHOT_H
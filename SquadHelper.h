@@ -3,70 +3,234 @@
 #ifndef SQUADHELPER_H
 #define SQUADHELPER_H
 
-#include "Player_Organizer.h"
-#include <unordered_map>
+#include "PlayerTable.h"
+#include "SearchProfile.h"
+#include <algorithm>
 #include <vector>
 
-int calculateChem(const std::vector<Player>& squad) {
-    std::unordered_map<std::string, int> clubCount, nationCount, leagueCount;
-    int totalChem = 0;
-
-    // Count appearances
-    for (const Player& p : squad) {
-        clubCount[p.team]++;
-        nationCount[p.nation]++;
-        leagueCount[p.league]++;
-    }
-
-    for (const Player& p : squad) {
-        int chem = 0;
+// Chemistry points a player earns from the number of squad members (including themselves) sharing their club,
+// nation or league. Every chemistry calculation goes through these so the thresholds live in one place.
+inline int clubChemPoints(int clubNum) {
+    if (clubNum >= 7) return 3;
+    if (clubNum >= 4) return 2;
+    if (clubNum >= 2) return 1;
+    return 0;
+}
 
-        // Club chemistry
-        int clubNum = clubCount[p.team];
-        if (clubNum >= 7) chem += 3;
-        else if (clubNum >= 4) chem += 2;
-        else if (clubNum >= 2) chem += 1;
+inline int nationChemPoints(int nationNum) {
+    if (nationNum >= 8) return 3;
+    if (nationNum >= 5) return 2;
+    if (nationNum >= 2) return 1;
+    return 0;
+}
 
-        // Nation chemistry
-        int nationNum = nationCount[p.nation];
-        if (nationNum >= 8) chem += 3;
-        else if (nationNum >= 5) chem += 2;
-        else if (nationNum >= 2) chem += 1;
+inline int leagueChemPoints(int leagueNum) {
+    if (leagueNum >= 8) return 3;
+    if (leagueNum >= 5) return 2;
+    if (leagueNum >= 3) return 1;
+    return 0;
+}
 
-        // League chemistry
-        int leagueNum = leagueCount[p.league];
-        if (leagueNum >= 8) chem += 3;
-        else if (leagueNum >= 5) chem += 2;
-        else if (leagueNum >= 3) chem += 1;
+// A player's chemistry is clamped to 3
+inline int playerChem(int clubNum, int nationNum, int leagueNum) {
+    int chem = clubChemPoints(clubNum) + nationChemPoints(nationNum) + leagueChemPoints(leagueNum);
+    return chem > 3 ? 3 : chem;
+}
 
-        // Clamp each player's chem to 3 max (optional if needed)
-        if (chem > 3) chem = 3;
+// A squad is a list of row indexes into the PlayerTable, and since it never holds more than 11 players
+// the group counts are plain integer compares.
+int calculateChem(const int* squad, int size, const PlayerTable& table) {
+    PROFILE_TIME(TIME_CHEMISTRY);
+    int totalChem = 0;
 
-        totalChem += chem;
+    for (int i = 0; i < size; i++) {
+        int row = squad[i];
+        int clubNum = 0, nationNum = 0, leagueNum = 0;
+        for (int j = 0; j < size; j++) {
+            int other = squad[j];
+            if (table.clubIds[other] == table.clubIds[row]) clubNum++;
+            if (table.nationIds[other] == table.nationIds[row]) nationNum++;
+            if (table.leagueIds[other] == table.leagueIds[row]) leagueNum++;
+        }
+
+        totalChem += playerChem(clubNum, nationNum, leagueNum);
     }
 
-    // Chemistry cap: 11 players × 3 = 33 max
     if (totalChem > 33) totalChem = 33;
     return totalChem;
 }
 
-int calculateAverageRating(const std::vector<Player>& squad) {
+int calculateChem(const std::vector<int>& squad, const PlayerTable& table) {
+    return calculateChem(squad.data(), static_cast<int>(squad.size()), table);
+}
+
+int calculateAverageRating(const std::vector<int>& squad, const PlayerTable& table) {
     if (squad.empty()) return 0;
 
     int totalRating = 0;
-    for (const Player& p : squad) {
-        totalRating += p.rating;
+    for (int row : squad) {
+        totalRating += table.ratings[row];
     }
 
     return totalRating / static_cast<int>(squad.size());
 }
 
-int calculateTotalSquadValue(const std::vector<Player>& squad) {
+int calculateTotalSquadValue(const std::vector<int>& squad, const PlayerTable& table) {
     int totalValue = 0;
-    for (const Player& p : squad) {
-        totalValue += p.value;
+    for (int row : squad) {
+        totalValue += table.values[row];
     }
     return totalValue;
 }
 
+// Number of squad members in each distinct club, nation or league. A squad has at most 11 players, so a
+// short array scan replaces a hash map.
+struct ChemGroupCounts {
+    int ids[11];
+    int counts[11];
+    int size = 0;
+
+    int Count(int id) const {
+        for (int i = 0; i < size; i++) {
+            if (ids[i] == id) return counts[i];
+        }
+        return 0;
+    }
+
+    int Max() const {
+        int best = 0;
+        for (int i = 0; i < size; i++) best = std::max(best, counts[i]);
+        return best;
+    }
+
+    // Returns the new count for id
+    int Add(int id) {
+        for (int i = 0; i < size; i++) {
+            if (ids[i] == id) return ++counts[i];
+        }
+        ids[size] = id;
+        counts[size] = 1;
+        size++;
+        return 1;
+    }
+
+    void Remove(int id) {
+        for (int i = 0; i < size; i++) {
+            if (ids[i] != id) continue;
+            if (--counts[i] == 0) {
+                size--;
+                ids[i] = ids[size];
+                counts[i] = counts[size];
+            }
+            return;
+        }
+    }
+};
+
+// Chemistry of a squad that is built one player at a time. Adding or removing a player updates the group
+// counts and only re-scores the members that share a club, nation or league with that player, so the total
+// always equals calculateChem on the same squad without rebuilding anything.
+class ChemistryState {
+public:
+    static constexpr int kMaxPlayers = 11;
+
+private:
+    ChemGroupCounts clubs, nations, leagues;
+    int rows[kMaxPlayers];
+    int clubOf[kMaxPlayers], nationOf[kMaxPlayers], leagueOf[kMaxPlayers];
+    int chemOf[kMaxPlayers];
+    int size = 0;
+    int total = 0;
+
+    // Re-scores every member that shares a group with the given ids
+    void rescoreLinked(int club, int nation, int league) {
+        for (int i = 0; i < size; i++) {
+            if (clubOf[i] != club && nationOf[i] != nation && leagueOf[i] != league) continue;
+            int chem = playerChem(clubs.Count(clubOf[i]), nations.Count(nationOf[i]), leagues.Count(leagueOf[i]));
+            total += chem - chemOf[i];
+            chemOf[i] = chem;
+        }
+    }
+
+public:
+    void Add(int row, const PlayerTable& table) {
+        if (size == kMaxPlayers) return;
+        int club = table.clubIds[row], nation = table.nationIds[row], league = table.leagueIds[row];
+        clubs.Add(club);
+        nations.Add(nation);
+        leagues.Add(league);
+
+        rows[size] = row;
+        clubOf[size] = club;
+        nationOf[size] = nation;
+        leagueOf[size] = league;
+        chemOf[size] = 0;
+        size++;
+        rescoreLinked(club, nation, league);
+    }
+
+    void Remove(int row) {
+        for (int i = 0; i < size; i++) {
+            if (rows[i] != row) continue;
+            int club = clubOf[i], nation = nationOf[i], league = leagueOf[i];
+            clubs.Remove(club);
+            nations.Remove(nation);
+            leagues.Remove(league);
+            total -= chemOf[i];
+
+            size--;
+            rows[i] = rows[size];
+            clubOf[i] = clubOf[size];
+            nationOf[i] = nationOf[size];
+            leagueOf[i] = leagueOf[size];
+            chemOf[i] = chemOf[size];
+            rescoreLinked(club, nation, league);
+            return;
+        }
+    }
+
+    // Chemistry the squad would have with row added, leaving the state unchanged
+    int TotalChemistryWith(int row, const PlayerTable& table) {
+        PROFILE_TIME(TIME_CHEMISTRY);
+        if (size == kMaxPlayers) return TotalChemistry();
+        Add(row, table);
+        int chem = TotalChemistry();
+        Remove(row);
+        return chem;
+    }
+
+    // Upper bound on the chemistry this squad can reach once remainingSlots more players join. Every new player
+    // scores at most 3, and an existing player can at best gain remainingSlots members in each of their groups.
+    int MaxReachableChemistry(int remainingSlots) const {
+        PROFILE_TIME(TIME_CHEMISTRY);
+        int best = remainingSlots * 3;
+        for (int i = 0; i < size; i++) {
+            best += playerChem(clubs.Count(clubOf[i]) + remainingSlots, nations.Count(nationOf[i]) + remainingSlots,
+                               leagues.Count(leagueOf[i]) + remainingSlots);
+        }
+        return best > 33 ? 33 : best;
+    }
+
+    // Chemistry cap: 11 players × 3 = 33 max
+    int TotalChemistry() const { return total > 33 ? 33 : total; }
+    int Size() const { return size; }
+
+    // Number of squad members sharing the player's nation, club and league, summed over the three groups
+    int LinkCount(int row, const PlayerTable& table) const {
+        return nations.Count(table.nationIds[row]) + clubs.Count(table.clubIds[row]) + leagues.Count(table.leagueIds[row]);
+    }
+
+    // The largest LinkCount any player could have against this squad
+    int MaxLinkCount() const { return nations.Max() + clubs.Max() + leagues.Max(); }
+
+    // Distinct clubs, nations and leagues in the squad with their member counts
+    const ChemGroupCounts& Clubs() const { return clubs; }
+    const ChemGroupCounts& Nations() const { return nations; }
+    const ChemGroupCounts& Leagues() const { return leagues; }
+
+    int ClubCount(int clubId) const { return clubs.Count(clubId); }
+    int NationCount(int nationId) const { return nations.Count(nationId); }
+    int LeagueCount(int leagueId) const { return leagues.Count(leagueId); }
+};
+
 #endif //SQUADHELPER_H
@@ -1,49 +1,16 @@
 #ifndef SQUADOPTIMIZER_H
 #define SQUADOPTIMIZER_H
 #include "Player_Organizer.h"
+#include "PlayerTable.h"
+#include "CandidateRanker.h"
+#include "Heuristic.h"
+#include "QuotaTracker.h"
 #include "Requirements.h"
+#include "SearchProfile.h"
+#include "SquadHelper.h"
+#include "SquadSearch.h"
 #include <vector>
-#include <unordered_map>
 #include <queue>
-#include <unordered_set>
-
-
-//Node representation to be used in A*
-struct SquadNode {
-  std::vector<Player> currentSquad; // Players added so far
-  std::unordered_set<std::string> usedNames; // Keeps track of already used players to prevent duplicates
-  int positionIndex; // Which position in formation we’re filling next
-  int costSoFar;     // Current squad value
-  int estimatedTotalCost; // costSoFar + heuristic
-  int totalChemistry; // Chemistry of the current squad
-
-  bool operator>(const SquadNode& other) const {
-    return estimatedTotalCost > other.estimatedTotalCost; // For min-heap
-  }
-};
-
-//Helper function that estimates the potential chemistry boost a player would have to a squad
-int estChemBoost(const Player& player, const std::vector<Player>& currentSquad) {
-    int boost = 0;
-    for(const Player& p : currentSquad) {
-        if(player.nation == p.nation) boost++;
-        if(player.team == p.team) boost++;
-        if(player.league == p.league) boost++;
-    }
-    return boost;
-}
-
-
-//Heuristic [h(n)]: Estimates the remaining cost based on the cheapest player per position
-int heuristic(const std::vector<std::string>& remainingPositions, const std::unordered_map<std::string, std::vector<Player>>& playerByPosition) {
-  int estValue = 0;
-  for (const auto& pos : remainingPositions) {
-    if (playerByPosition.count(pos) && !playerByPosition.at(pos).empty()) {
-      estValue += playerByPosition.at(pos)[0].value; //Use the cheapest player's value to minimize cost
-    }
-  }
-  return estValue;
-}
 
 
 /*
@@ -54,86 +21,59 @@ int heuristic(const std::vector<std::string>& remainingPositions, const std::uno
   - g(n) is the cost of the path from the start node to n
   - h(n) is a heuristic function that estimates the cost of the cheapest path from n to the goal
 
+  h(n) comes from a HeuristicTable built once per search, so it never overestimates and the first valid
+  squad taken off the open set is the cheapest one.
+
   Information from https://en.wikipedia.org/wiki/A*_search_algorithm
 */
 
-std::vector<Player> AStarSquadOptimizer(
-    const std::vector<std::string>& formation,
-    const std::unordered_map<std::string, std::vector<Player>>& playerByPosition,
-    const SquadRequirements& req
+std::vector<int> AStarSquadOptimizer(
+    const Formation& formation,
+    const PlayerTable& table,
+    const PlayerByPosition& playerByPosition,
+    const SquadRequirements& req,
+    SearchStats* stats = nullptr
 ) {
+    PROFILE_SCOPE(stats ? &stats->profile : nullptr); // Pruning counts and timers of this search go to stats
 
-    std::priority_queue<SquadNode, std::vector<SquadNode>, std::greater<SquadNode>> pq; // The open set of nodes to try
+    SquadSearchContext search(formation, table, playerByPosition, req);
+    ExpansionScratch scratch = search.MakeScratch(); // Reused by every expansion
+    std::vector<OpenEntry> children;
+    std::vector<int> squad;
 
-    //Initialize the starting node. Represents an empty squad
-    SquadNode start;
-    start.positionIndex = 0;
-    start.costSoFar = 0;
-    start.estimatedTotalCost = heuristic(formation, playerByPosition);
-    start.totalChemistry = 0;
-    pq.push(start);
+    NodeArena arena; // Owns every node created by this search
+    TranspositionTable expanded(formation); // Partial squads already expanded, so each set of players is expanded once
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> pq; // The open set of nodes to try
+
+    SquadNode* start = search.MakeStart(arena);
+    if (!start) return {};
+    pq.push({start->estimatedTotalCost, start->positionIndex, start});
 
     //Main search Loop: Explores the lowest estimated-cost node at each step
     while (!pq.empty()) {
-        SquadNode current = pq.top(); // Represents the best squad so far
+        const SquadNode& current = *pq.top().node; // Represents the best squad so far
+        if (stats) {
+            stats->nodesExpanded++;
+            stats->peakOpenSize = std::max(stats->peakOpenSize, pq.size());
+        }
         pq.pop();
 
         //Once a full squad is made, validate if it meets all requirements
-        if (current.positionIndex == formation.size()) {
-            if (DoesSquadMeetRequirements(current.currentSquad, req)) {
-                return current.currentSquad; //Found a valid squad and returns it
+        if (search.IsComplete(current)) {
+            if (search.IsValidSquad(current, squad)) {
+                return squad; //Found a valid squad and returns it
             }
             continue; //No valid squad was found so we keep going
         }
-
-        std::string currentPosition = formation[current.positionIndex];
-        if (!playerByPosition.count(currentPosition)) continue;
-
-        // Create and sort a list of the best candidates per position based on a score.
-        // Score is calculated by finding each player's rating-value ratio and multiplying it by
-        // the estimated chemistry boost they will have to the squad.
-        // 0.1 is multiplied to the chemistry boost so that the algorithm doesn't heavily favor increasing chemistry
-        std::vector<Player> candidates = playerByPosition.at(currentPosition);
-        std::sort(candidates.begin(), candidates.end(), [&](const Player& a, const Player& b) {
-            double aScore = (a.value > 0 ? (double)a.rating / a.value : a.rating) + 0.3 * estChemBoost(a, current.currentSquad);
-            double bScore = (b.value > 0 ? (double)b.rating / b.value : b.rating) + 0.3 * estChemBoost(b, current.currentSquad);
-            return aScore > bScore;
-        });
-
-        //Try all candidates for the current position
-        for (const Player& p : candidates) {
-            if (current.usedNames.count(p.name)) continue; //Checks if current player has already been selected
-            if (current.costSoFar + p.value > req.maxBudget) continue; //Checks if we have gone above budget
-
-            //Create the next state with the found player added to the squad
-            SquadNode next = current;
-            next.currentSquad.push_back(p);
-            next.usedNames.insert(p.name); //Update the current list of used players
-            next.positionIndex++; //Move on to the next position
-            next.costSoFar += p.value; //Update the current cost of our squad
-            next.totalChemistry = calculateChem(next.currentSquad); //Update the total chemistry of the squad
-
-            // Checks if squad has 6 or more players in it already. Then checks if it is possible to reach
-            // required rating or squad chemistry. If it is impossible, then skips the loop. This makes the
-            // program work faster since we aren't trying every single player to fill a squad that is impossible to make
-            if (next.currentSquad.size() >= 6) {
-                int projectedRating = calculateAverageRating(next.currentSquad) * next.currentSquad.size();
-                int remainingSlots = 11 - next.currentSquad.size();
-                projectedRating += remainingSlots * 99;
-                projectedRating /= 11;
-
-                if (projectedRating < req.minOverallRating * 0.95) continue;
-
-                int maxPossibleChem = next.totalChemistry + remainingSlots * 3;
-                if (maxPossibleChem < req.minTeamChemistry * 0.95) continue;
-            }
-
-            // Compute remaining cost and push next node
-            std::vector<std::string> remainingPositions(formation.begin() + next.positionIndex, formation.end());
-            int h = heuristic(remainingPositions, playerByPosition);
-            next.estimatedTotalCost = next.costSoFar + h;
-            pq.push(next);
+        if (!expanded.Insert(&current)) {
+            if (stats) stats->transpositions++;
+            continue; //Same players as a squad that was already expanded
         }
+
+        children.clear();
+        search.Expand(current, arena, scratch, children);
+        for (const OpenEntry& child : children) pq.push(child);
+        if (stats) stats->nodesGenerated += children.size();
     }
 
     return {}; //Case for where no squad is found
@@ -142,54 +82,82 @@ std::vector<Player> AStarSquadOptimizer(
 // Best-Fit Squad Builder
 // Best-Fit (Greedy) Squad Builder Algorithm
 // Builds a squad by selecting the best player (based on rating/value) for each position one by one
-std::vector<Player> BestFitSquadOptimizer(
-    const std::vector<std::string>& formation,
-    const std::unordered_map<std::string, std::vector<Player>>& playerByPosition,
-    const SquadRequirements& req)
+std::vector<int> BestFitSquadOptimizer(
+    const Formation& formation,
+    const PlayerTable& table,
+    const PlayerByPosition& playerByPosition,
+    const SquadRequirements& req,
+    SearchStats* stats = nullptr)
 {
-    std::vector<Player> bestFitSquad;
-    std::unordered_set<std::string> usedPlayers; // Used to prevent picking duplicate players
+    PROFILE_SCOPE(stats ? &stats->profile : nullptr);
+    std::vector<int> bestFitSquad;
+    IdentitySet usedPlayers(table.identityCount); // Footballers already picked, so no one is picked twice
+    ChemistryState chemistry; // Chemistry of bestFitSquad, updated as players are picked
     int totalCost = 0;
 
+    CandidateRanker ranker(formation, table, playerByPosition);
+    RankedCandidates candidates;
+
+    // Players each nation, league and club quota still needs. A candidate is skipped if taking them would
+    // leave too few open slots to fill the quotas, so quota players get picked before it is too late.
+    QuotaTracker quotaTracker(formation, table, playerByPosition, resolveQuotas(req, table));
+    const std::vector<QuotaGroup>& quotas = quotaTracker.Quotas();
+    std::vector<int> outstanding(quotas.size());
+    std::vector<int> childOutstanding(quotas.size());
+    for (size_t g = 0; g < quotas.size(); g++) outstanding[g] = quotas[g].count;
+    if (!quotaTracker.CanStillMeet(0, outstanding.data())) return {};
 
     // Loops through each required position in the given formation
-    for(const std::string& pos : formation) {
-        if(!playerByPosition.count(pos)) continue;
+    for(int slot = 0; slot < static_cast<int>(formation.size()); slot++) {
+        if(!ranker.HasCandidates(slot)) continue;
 
 
-        // Create and sort a list of best candidates per position based on a score.
-        // Score is calculated by finding each player's rating-value ratio and multiplying it by
+        // Take the best candidates for this position one at a time based on a score.
+        // Score is calculated by finding each player's rating-value ratio plus
         // the estimated chemistry boost they will have to the squad.
         // 0.1 is multiplied to the chemistry boost so that the algorithm doesn't heavily favor increasing chemistry
-
-
-        std::vector<Player> candidates = playerByPosition.at(pos);
-        std::sort(candidates.begin(), candidates.end(), [&](const Player& a, const Player& b) {
-            double aScore = (a.value > 0 ? (double)a.rating / a.value : a.rating)  + 0.1 * estChemBoost(a, bestFitSquad);
-            double bScore = (b.value > 0 ? (double)b.rating / b.value : b.rating) + 0.1 * estChemBoost(b, bestFitSquad);
-            return aScore > bScore;
-        });
+        // Only the candidates actually looked at get scored.
+        ranker.Rank(slot, chemistry, table, 0.1, candidates);
 
         bool found = false;
         int tried =0;
 
-        for(const Player& p : candidates) {
-            if(tried >= 250) break;
-            if(usedPlayers.count(p.name)) continue;
-            if(totalCost + p.value > req.maxBudget) continue;
+        int p;
+        while(candidates.Next(p)) {
+            if(tried >= 250) {
+                PROFILE_COUNT(PRUNE_TRIED_CAP);
+                break;
+            }
+            if(stats) stats->nodesExpanded++;
+            if(usedPlayers.Contains(table.identityIds[p])) {
+                PROFILE_COUNT(PRUNE_DUPLICATE);
+                continue;
+            }
+            if(totalCost + table.values[p] > req.maxBudget) {
+                PROFILE_COUNT(PRUNE_BUDGET);
+                continue;
+            }
 
-            std::vector<Player> tempSquad = bestFitSquad;
-            tempSquad.push_back(p);
+            for (size_t g = 0; g < quotas.size(); g++) {
+                childOutstanding[g] = outstanding[g] - (quotas[g].Contains(p, table) ? 1 : 0);
+            }
+            if (!quotaTracker.CanStillMeet(slot + 1, childOutstanding.data())) {
+                PROFILE_COUNT(PRUNE_QUOTA);
+                continue;
+            }
 
-            if (calculateChem(tempSquad) < req.minTeamChemistry && tempSquad.size() == 11) {
+            if (bestFitSquad.size() + 1 == 11 && chemistry.TotalChemistryWith(p, table) < req.minTeamChemistry) {
+                PROFILE_COUNT(PRUNE_CHEMISTRY);
                 ++tried;
                 continue;
             }
 
             // Add found player to the squad and update state of the algorithm
             bestFitSquad.push_back(p);
-            usedPlayers.insert(p.name);
-            totalCost += p.value;
+            chemistry.Add(p, table);
+            usedPlayers.Insert(table.identityIds[p]);
+            totalCost += table.values[p];
+            outstanding.swap(childOutstanding);
             found = true;
             break; // Uses the first valid player
         }
@@ -198,7 +166,7 @@ std::vector<Player> BestFitSquadOptimizer(
             return {}; // Means that this position could not be filled
         }
     }
-    if(!DoesSquadMeetRequirements(bestFitSquad, req)) {
+    if(!RequirementChecker(req, table, static_cast<int>(formation.size())).Check(bestFitSquad, table)) {
         return {}; //If not valid squad is found, return an empty team
     }
 
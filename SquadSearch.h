@@ -0,0 +1,340 @@
+#ifndef SQUAD_SEARCH_H
+#define SQUAD_SEARCH_H
+
+#include "PlayerTable.h"
+#include "CandidateRanker.h"
+#include "Heuristic.h"
+#include "QuotaTracker.h"
+#include "Requirements.h"
+#include "SearchProfile.h"
+#include "SquadHelper.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//Node representation to be used in A*. A node only records the player it added; the squad so far is
+//the chain of parent nodes, which is at most 11 long and is walked when the node is expanded.
+struct SquadNode {
+  const SquadNode* parent; // Node this one was created from, nullptr for the empty squad
+  int player;        // Row of the player added by this node, -1 for the empty squad
+  int positionIndex; // Which position in formation we’re filling next
+  int costSoFar;     // Current squad value
+  int estimatedTotalCost; // costSoFar + heuristic
+  int totalChemistry; // Chemistry of the current squad
+  uint64_t squadHash; // XOR of squadKey over the squad's rows, the same for any order they were picked in
+};
+
+//Entry in the open set. The f-value is copied next to the pointer so the heap never has to follow it.
+struct OpenEntry {
+  int estimatedTotalCost;
+  int positionIndex;
+  const SquadNode* node;
+
+  // For min-heap. Ties on f go to the deeper node, which reaches a full squad sooner without changing which
+  // cost is found first.
+  bool operator>(const OpenEntry& other) const {
+    if (estimatedTotalCost != other.estimatedTotalCost) return estimatedTotalCost > other.estimatedTotalCost;
+    return positionIndex < other.positionIndex;
+  }
+};
+
+//Hands out SquadNodes from fixed-size blocks. Blocks never move, so parent pointers stay valid,
+//and every node is freed at once when the arena goes out of scope at the end of the search.
+class NodeArena {
+private:
+  static constexpr size_t kBlockSize = 4096;
+  std::vector<std::unique_ptr<SquadNode[]>> blocks;
+  size_t currentBlock = 0;
+  size_t usedInBlock = kBlockSize;
+
+public:
+  SquadNode* Allocate() {
+    if (usedInBlock == kBlockSize) {
+      if (!blocks.empty()) currentBlock++;
+      if (currentBlock == blocks.size()) blocks.emplace_back(new SquadNode[kBlockSize]);
+      usedInBlock = 0;
+    }
+    return &blocks[currentBlock][usedInBlock++];
+  }
+
+  //Frees every node at once but keeps the blocks, so refilling the arena does not allocate again
+  void Reset() {
+    currentBlock = 0;
+    usedInBlock = blocks.empty() ? kBlockSize : 0;
+  }
+
+  size_t Size() const { return blocks.empty() ? 0 : currentBlock * kBlockSize + usedInBlock; }
+};
+
+//Walks the parent chain and writes the squad's rows in formation order. Returns the number of players.
+inline int collectSquad(const SquadNode* node, int* rows) {
+  int count = node->positionIndex;
+  for (int i = count - 1; node && node->player >= 0; node = node->parent, i--) {
+    rows[i] = node->player;
+  }
+  return count;
+}
+
+//Random-looking 64-bit key of one row (splitmix64), XORed together into SquadNode::squadHash
+inline uint64_t squadKey(int row) {
+  uint64_t z = static_cast<uint64_t>(row) + 0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+//Remembers every partial squad already expanded, keyed by the set of players in it. Two nodes with the same
+//players have the same cost, chemistry, outstanding quotas and open slots, so everything below them is the
+//same and only the first one taken off the open set needs to be expanded. This happens when players who
+//can play several positions swap slots, Ex: A at CB and B at CDM against B at CB and A at CDM.
+//Because of the rising-row rule, the player in a slot that a later slot of the same position still has to
+//follow also matters, so those have to match as well. Hashes are only a first check; on a match the two
+//squads are compared row by row.
+class TranspositionTable {
+private:
+  std::unordered_multimap<uint64_t, const SquadNode*> seen;
+  std::vector<std::vector<int>> boundarySlots; // [depth] filled slots that an open slot has to follow
+
+  bool sameState(const SquadNode* a, const SquadNode* b) const {
+    if (a->positionIndex != b->positionIndex) return false;
+    int rowsA[ChemistryState::kMaxPlayers], rowsB[ChemistryState::kMaxPlayers];
+    int size = collectSquad(a, rowsA);
+    collectSquad(b, rowsB);
+    for (int slot : boundarySlots[size]) {
+      if (rowsA[slot] != rowsB[slot]) return false;
+    }
+    return std::is_permutation(rowsA, rowsA + size, rowsB);
+  }
+
+public:
+  explicit TranspositionTable(const Formation& formation) : boundarySlots(formation.size() + 1) {
+    SlotGroups groups = MakeSlotGroups(formation);
+    for (size_t depth = 0; depth <= formation.size(); depth++) {
+      for (size_t slot = depth; slot < formation.size(); slot++) {
+        int earlier = groups.previousSameSlot[slot];
+        if (earlier >= 0 && earlier < static_cast<int>(depth)) boundarySlots[depth].push_back(earlier);
+      }
+    }
+  }
+
+  //Returns false if an equivalent node was inserted before, otherwise records node
+  bool Insert(const SquadNode* node) {
+    auto range = seen.equal_range(node->squadHash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (sameState(it->second, node)) return false;
+    }
+    seen.emplace(node->squadHash, node);
+    return true;
+  }
+
+  size_t Size() const { return seen.size(); }
+};
+
+//Counters filled in by an optimizer when the caller asks for them (Ex: the benchmark driver)
+struct SearchStats {
+  long long nodesExpanded = 0;  // Nodes taken off the open set (A*) or candidates looked at (Best Fit)
+  long long nodesGenerated = 0; // Children pushed onto the open set
+  long long transpositions = 0; // Nodes skipped because a squad with the same players was already expanded
+  size_t peakOpenSize = 0;      // Largest the open set got
+  SearchProfile profile;        // Pruning counts and timers, only filled in when built with SQUAD_PROFILE
+
+  std::string ToJSON() const {
+    std::string json = "{\"nodesExpanded\": " + std::to_string(nodesExpanded) +
+                       ", \"nodesGenerated\": " + std::to_string(nodesGenerated) +
+                       ", \"transpositions\": " + std::to_string(transpositions) +
+                       ", \"peakOpenSize\": " + std::to_string(peakOpenSize);
+#ifdef SQUAD_PROFILE
+    json += ", \"profile\": " + profile.ToJSON();
+#endif
+    return json + "}";
+  }
+};
+
+//Per-thread buffers reused by every expansion
+struct ExpansionScratch {
+  RankedCandidates candidates;
+  IdentitySet usedIdentities;         // Footballers already in the squad being expanded, empty between expansions
+  std::vector<int> outstanding;      // Players each quota still needs in the node being expanded
+  std::vector<int> childOutstanding;
+};
+
+//Everything an A* search over one formation needs that does not change while it runs. It is only read
+//during the search, so several threads can expand nodes with the same context at once.
+class SquadSearchContext {
+private:
+  const Formation& formation;
+  const PlayerTable& table;
+  const SquadRequirements& req;
+  HeuristicTable heuristic;
+  QuotaTracker quotaTracker;
+  CandidateRanker ranker;
+  SlotGroups slotGroups; // Slots with the same position only take players in rising row order
+  RequirementChecker checker; // Goal test for full squads
+
+public:
+  SquadSearchContext(const Formation& formation,
+                     const PlayerTable& table,
+                     const PlayerByPosition& playerByPosition,
+                     const SquadRequirements& req)
+      : formation(formation), table(table), req(req),
+        heuristic(formation, table, playerByPosition, resolveQuotas(req, table)),
+        quotaTracker(formation, table, playerByPosition, heuristic.Quotas()),
+        ranker(formation, table, playerByPosition), slotGroups(MakeSlotGroups(formation)),
+        checker(req, table, static_cast<int>(formation.size())) {}
+
+  const Formation& GetFormation() const { return formation; }
+  const PlayerTable& Table() const { return table; }
+  const HeuristicTable& Heuristic() const { return heuristic; }
+
+  ExpansionScratch MakeScratch() const {
+    ExpansionScratch scratch;
+    scratch.usedIdentities = IdentitySet(table.identityCount);
+    scratch.outstanding.resize(heuristic.Quotas().size());
+    scratch.childOutstanding.resize(heuristic.Quotas().size());
+    return scratch;
+  }
+
+  //Initialize the starting node. Represents an empty squad. Returns nullptr if no squad can be built at all.
+  SquadNode* MakeStart(NodeArena& arena) const {
+    const std::vector<QuotaGroup>& quotas = heuristic.Quotas();
+    std::vector<int> outstanding(quotas.size());
+    for (size_t g = 0; g < quotas.size(); g++) outstanding[g] = quotas[g].count;
+
+    if (!quotaTracker.CanStillMeet(0, outstanding.data())) return nullptr;
+    int h = heuristic.Estimate(0, outstanding.data());
+    if (h == HeuristicTable::kInfeasible || h > req.maxBudget) return nullptr;
+
+    SquadNode* start = arena.Allocate();
+    start->parent = nullptr;
+    start->player = -1;
+    start->positionIndex = 0;
+    start->costSoFar = 0;
+    start->estimatedTotalCost = h;
+    start->totalChemistry = 0;
+    start->squadHash = 0;
+    return start;
+  }
+
+  bool IsComplete(const SquadNode& node) const {
+    return node.positionIndex == static_cast<int>(formation.size());
+  }
+
+  //Validates a full squad against all requirements. Writes the squad to squad either way.
+  bool IsValidSquad(const SquadNode& node, std::vector<int>& squad) const {
+    int squadRows[ChemistryState::kMaxPlayers];
+    int squadSize = collectSquad(&node, squadRows);
+    squad.assign(squadRows, squadRows + squadSize);
+    return checker.Check(squadRows, squadSize, table);
+  }
+
+  //Creates every child of node that can still lead to a valid squad, allocating them from arena and
+  //appending their open-set entries to children
+  void Expand(const SquadNode& current, NodeArena& arena, ExpansionScratch& scratch, std::vector<OpenEntry>& children) const {
+    if (!ranker.HasCandidates(current.positionIndex)) return;
+
+    const std::vector<QuotaGroup>& quotas = heuristic.Quotas();
+    int squadRows[ChemistryState::kMaxPlayers]; // Squad of the node being expanded, rebuilt from its parent chain
+    int squadSize = collectSquad(&current, squadRows);
+
+    // Chemistry counts, used footballers and outstanding quotas of the current squad, shared by every child
+    ChemistryState chemistry;
+    int ratingSum = 0;
+    for (size_t g = 0; g < quotas.size(); g++) scratch.outstanding[g] = quotas[g].count;
+    for (int i = 0; i < squadSize; i++) {
+      chemistry.Add(squadRows[i], table);
+      scratch.usedIdentities.Insert(table.identityIds[squadRows[i]]);
+      ratingSum += table.ratings[squadRows[i]];
+      for (size_t g = 0; g < quotas.size(); g++) {
+        if (quotas[g].Contains(squadRows[i], table)) scratch.outstanding[g]--;
+      }
+    }
+
+    // Go through the candidates for this position best first. Score is calculated from each player's
+    // rating-value ratio plus the estimated chemistry boost they will have to the squad.
+    // 0.3 is multiplied to the chemistry boost so that the algorithm doesn't heavily favor increasing chemistry
+    // Every candidate is tried, so the whole pool is scored at once.
+    ranker.Rank(current.positionIndex, chemistry, table, 0.3, scratch.candidates, true);
+
+    // Slots with the same position draw from the same list, so swapping their players gives the same squad.
+    // Only the order with rising rows across those slots is built; any squad can be reordered that way.
+    int previousSlot = slotGroups.previousSameSlot[current.positionIndex];
+    int minRow = previousSlot >= 0 ? squadRows[previousSlot] : -1;
+
+    //Try all candidates for the current position
+    int p;
+    while (scratch.candidates.Next(p)) {
+      if (p <= minRow) { //Already covered by the squad with these two players the other way around
+        PROFILE_COUNT(PRUNE_SYMMETRY);
+        continue;
+      }
+      //Checks if current player (any version of them) has already been selected
+      if (scratch.usedIdentities.Contains(table.identityIds[p])) {
+        PROFILE_COUNT(PRUNE_DUPLICATE);
+        continue;
+      }
+      if (current.costSoFar + table.values[p] > req.maxBudget) { //Checks if we have gone above budget
+        PROFILE_COUNT(PRUNE_BUDGET);
+        continue;
+      }
+
+      int nextSize = squadSize + 1;
+      int nextCost = current.costSoFar + table.values[p]; //Update the current cost of our squad
+      int nextChemistry = chemistry.TotalChemistryWith(p, table); //Update the total chemistry of the squad
+
+      // Checks if squad has 6 or more players in it already. Then checks if it is possible to reach
+      // required rating or squad chemistry. If it is impossible, then skips the loop. This makes the
+      // program work faster since we aren't trying every single player to fill a squad that is impossible to make
+      // Both projections are upper bounds, so only squads that can never qualify are cut.
+      if (nextSize >= 6) {
+        int remainingSlots = 11 - nextSize;
+        int projectedRating = (ratingSum + table.ratings[p] + remainingSlots * 99) / 11;
+
+        if (projectedRating < req.minOverallRating * 0.95) {
+          PROFILE_COUNT(PRUNE_RATING);
+          continue;
+        }
+
+        chemistry.Add(p, table);
+        int maxPossibleChem = chemistry.MaxReachableChemistry(remainingSlots);
+        chemistry.Remove(p);
+        if (maxPossibleChem < req.minTeamChemistry * 0.95) {
+          PROFILE_COUNT(PRUNE_CHEMISTRY);
+          continue;
+        }
+      }
+
+      // Drop the child if the open slots can no longer cover its quotas, then look up the remaining cost.
+      // A child that cannot meet its quotas or the budget is never pushed.
+      for (size_t g = 0; g < quotas.size(); g++) {
+        scratch.childOutstanding[g] = scratch.outstanding[g] - (quotas[g].Contains(p, table) ? 1 : 0);
+      }
+      if (!quotaTracker.CanStillMeet(current.positionIndex + 1, scratch.childOutstanding.data())) {
+        PROFILE_COUNT(PRUNE_QUOTA);
+        continue;
+      }
+      int h = heuristic.Estimate(current.positionIndex + 1, scratch.childOutstanding.data());
+      if (h == HeuristicTable::kInfeasible || nextCost + h > req.maxBudget) {
+        PROFILE_COUNT(PRUNE_HEURISTIC);
+        continue;
+      }
+
+      //Create the next state with the found player added to the squad
+      SquadNode* next = arena.Allocate();
+      next->parent = &current;
+      next->player = p;
+      next->positionIndex = current.positionIndex + 1; //Move on to the next position
+      next->costSoFar = nextCost;
+      next->totalChemistry = nextChemistry;
+      next->estimatedTotalCost = next->costSoFar + h;
+      next->squadHash = current.squadHash ^ squadKey(p);
+      children.push_back({next->estimatedTotalCost, next->positionIndex, next});
+    }
+
+    for (int i = 0; i < squadSize; i++) scratch.usedIdentities.Erase(table.identityIds[squadRows[i]]);
+  }
+};
+
+#endif // SQUAD_SEARCH_H
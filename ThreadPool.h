@@ -0,0 +1,79 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running submitted jobs in submission order. Wait() blocks until every job
+// submitted so far has finished; the destructor waits and then stops the workers.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::condition_variable allDone;
+    int running = 0; // Jobs taken off the queue that have not finished yet
+    bool stopping = false;
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            jobReady.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (jobs.empty()) return; // Only reached when stopping
+
+            std::function<void()> job = std::move(jobs.front());
+            jobs.pop_front();
+            running++;
+            lock.unlock();
+
+            job();
+
+            lock.lock();
+            running--;
+            if (jobs.empty() && running == 0) allDone.notify_all();
+        }
+    }
+
+public:
+    // threadCount = 0 uses one thread per hardware core
+    explicit ThreadPool(unsigned threadCount = 0) {
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < threadCount; i++) workers.emplace_back([this]() { workerLoop(); });
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        Wait();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        jobReady.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    void Submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        jobReady.notify_one();
+    }
+
+    void Wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        allDone.wait(lock, [this]() { return jobs.empty() && running == 0; });
+    }
+
+    size_t Size() const { return workers.size(); }
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,71 @@
+#ifndef VERSION_POLICY_H
+#define VERSION_POLICY_H
+
+#include "PlayerTable.h"
+#include <string>
+#include <vector>
+
+// male_players.csv has one row per footballer per fifa_version/fifa_update. The policy decides which of
+// those rows are kept at load time.
+enum VersionPolicy {
+    VERSIONS_ALL,      // Keep every row; the optimizers still never pick the same footballer twice
+    VERSIONS_LATEST,   // Highest fifa_version, then fifa_update
+    VERSIONS_CHEAPEST, // Lowest value
+    VERSIONS_BEST      // Highest overall rating
+};
+
+inline const char* VersionPolicyName(VersionPolicy policy) {
+    switch (policy) {
+        case VERSIONS_LATEST: return "latest";
+        case VERSIONS_CHEAPEST: return "cheapest";
+        case VERSIONS_BEST: return "best";
+        default: return "all";
+    }
+}
+
+// Parses "all", "latest", "cheapest" or "best". Returns false for anything else.
+inline bool ParseVersionPolicy(const std::string& name, VersionPolicy& policy) {
+    for (VersionPolicy candidate : {VERSIONS_ALL, VERSIONS_LATEST, VERSIONS_CHEAPEST, VERSIONS_BEST}) {
+        if (name == VersionPolicyName(candidate)) {
+            policy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// True if row a should be kept over row b, another version of the same footballer. Remaining ties go to
+// the later version and then to the later row, so the choice never depends on file order alone.
+inline bool preferVersion(const PlayerTable& table, int a, int b, VersionPolicy policy) {
+    if (policy == VERSIONS_CHEAPEST && table.values[a] != table.values[b]) return table.values[a] < table.values[b];
+    if (policy == VERSIONS_BEST && table.ratings[a] != table.ratings[b]) return table.ratings[a] > table.ratings[b];
+    if (table.versions[a] != table.versions[b]) return table.versions[a] > table.versions[b];
+    return a > b;
+}
+
+// Keeps one row per identity according to policy, in the original row order. The string pools are kept
+// as they are.
+inline void ApplyVersionPolicy(PlayerTable& table, VersionPolicy policy) {
+    if (policy == VERSIONS_ALL) return;
+
+    std::vector<int> chosen(table.identityCount, -1); // Identity -> row kept for it
+    for (size_t row = 0; row < table.Size(); row++) {
+        int& best = chosen[table.identityIds[row]];
+        if (best < 0 || preferVersion(table, static_cast<int>(row), best, policy)) best = static_cast<int>(row);
+    }
+
+    PlayerTable kept;
+    kept.names = std::move(table.names);
+    kept.nations = std::move(table.nations);
+    kept.leagues = std::move(table.leagues);
+    kept.clubs = std::move(table.clubs);
+    kept.positions = std::move(table.positions);
+    for (size_t row = 0; row < table.Size(); row++) {
+        if (chosen[table.identityIds[row]] != static_cast<int>(row)) continue;
+        kept.AddRow(table.nameIds[row], table.ratings[row], table.values[row], table.nationIds[row], table.leagueIds[row],
+                    table.clubIds[row], table.positionMasks[row], table.playerIds[row], table.versions[row]);
+    }
+    table = std::move(kept);
+}
+
+#endif // VERSION_POLICY_H
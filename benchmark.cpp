@@ -0,0 +1,267 @@
+#include <iostream>
+#include "Player_Organizer.h"
+#include "PlayerTable.h"
+#include "Snapshot.h"
+#include "Formations.h"
+#include "IDAStarSquadOptimizer.h"
+#include "LocalSearch.h"
+#include "ParetoFilter.h"
+#include "Requirements.h"
+#include "RequirementsIO.h"
+#include "SquadOptimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+/*
+  Benchmark driver for the optimizers. Loads the players once, then runs every requirements record in the
+  given JSON Lines files through A*, Best Fit, Best Fit followed by simulated annealing (LocalSearch.h) and the
+  memory-bounded IDA* (IDAStarSquadOptimizer.h), and prints one row per case and algorithm:
+  - cold: the first run, including building and filtering the per-position lists for the case
+  - median / p95: the warm runs (--repeat N, lists reused), nearest-rank percentiles
+  - nodes: nodes expanded by A* or IDA* (over all its passes), candidates looked at by Best Fit (the annealing moves are not counted)
+  - cost / rating / chem of the squad found, and peak memory of the process so far
+
+  Usage: DSA_Project_3_benchmark <players.csv> <cases.jsonl>... [--repeat N] [--algorithm astar|bestfit|local|idastar|both|all]
+                                 [--versions all|latest|cheapest|best]
+         DSA_Project_3_benchmark <players.csv> --generate N [--seed S]   (writes N random cases to stdout)
+*/
+
+using BenchClock = std::chrono::steady_clock;
+
+static double millisecondsSince(BenchClock::time_point start) {
+    return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+}
+
+// Peak resident set size in MiB, 0 where it is not available
+static double peakMemoryMiB() {
+#ifndef _WIN32
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0); // Bytes on macOS
+#else
+    return usage.ru_maxrss / 1024.0; // KiB on Linux
+#endif
+#else
+    return 0;
+#endif
+}
+
+// Nearest-rank percentile of an unsorted sample
+static double percentile(std::vector<double> samples, double p) {
+    if (samples.empty()) return 0;
+    std::sort(samples.begin(), samples.end());
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * samples.size()));
+    return samples[std::min(samples.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+struct BenchCase {
+    std::string id;
+    SquadRequirements req;
+};
+
+static bool readCases(const std::string& path, std::vector<BenchCase>& cases) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "Error opening " << path << "\n";
+        return false;
+    }
+    std::string line, error;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        BenchCase benchCase;
+        if (!ParseRequirementsJSON(line, benchCase.req, benchCase.id, error)) {
+            std::cerr << path << ":" << lineNumber << ": " << error << "\n";
+            return false;
+        }
+        if (benchCase.id.empty()) benchCase.id = path + ":" + std::to_string(lineNumber);
+        cases.push_back(benchCase);
+    }
+    return true;
+}
+
+// Random requirements over the loaded players. Quota names are drawn from the groups of well-rated
+// players, weighted by how many such players they have, so most cases are solvable.
+static void generateCases(const PlayerTable& table, int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::string> formationNames = FormationNames();
+    std::sort(formationNames.begin(), formationNames.end()); // Sorted so the cases for a seed do not depend on the table order
+
+    std::vector<int> strongRows;
+    for (size_t row = 0; row < table.Size(); row++) {
+        if (table.ratings[row] >= 75) strongRows.push_back(static_cast<int>(row));
+    }
+    if (strongRows.empty()) {
+        for (size_t row = 0; row < table.Size(); row++) strongRows.push_back(static_cast<int>(row));
+    }
+    if (strongRows.empty()) return;
+
+    auto pick = [&](int n) { return std::uniform_int_distribution<int>(0, n - 1)(rng); };
+    int budgets[] = {250000, 500000, 1000000, 2000000};
+    int chemistry[] = {0, 0, 0, 5, 10};
+
+    for (int i = 0; i < count; i++) {
+        SquadRequirements req;
+        req.formation = formationNames[pick(static_cast<int>(formationNames.size()))];
+        req.maxBudget = budgets[pick(4)];
+        req.minOverallRating = 60 + pick(26);
+        req.minTeamChemistry = chemistry[pick(5)];
+
+        // Up to one quota of each kind, taken from a random strong player so the group exists
+        if (pick(2)) {
+            req.nations.emplace_back(table.nations.Get(table.nationIds[strongRows[pick(static_cast<int>(strongRows.size()))]]));
+            req.nationCounts.push_back(1 + pick(2));
+        }
+        if (pick(2)) {
+            req.leagues.emplace_back(table.leagues.Get(table.leagueIds[strongRows[pick(static_cast<int>(strongRows.size()))]]));
+            req.leagueCounts.push_back(1 + pick(2));
+        }
+        if (pick(3) == 0) {
+            req.clubs.emplace_back(table.clubs.Get(table.clubIds[strongRows[pick(static_cast<int>(strongRows.size()))]]));
+            req.clubCounts.push_back(1);
+        }
+        std::cout << RequirementsToJSON(req, "generated-" + std::to_string(i + 1)) << "\n";
+    }
+}
+
+static void printRow(const std::string& id, const std::string& algorithm, double cold, double median, double p95,
+                     long long nodes, const std::vector<int>& squad, const PlayerTable& table) {
+    std::cout << std::left << std::setw(22) << id << std::setw(9) << algorithm << std::right << std::fixed
+              << std::setprecision(3) << std::setw(11) << cold << std::setw(11) << median << std::setw(11) << p95
+              << std::setw(12) << nodes;
+    if (squad.empty()) {
+        std::cout << std::setw(10) << "-" << std::setw(8) << "-" << std::setw(6) << "-";
+    } else {
+        std::cout << std::setw(10) << calculateTotalSquadValue(squad, table) << std::setprecision(1) << std::setw(8)
+                  << calculateAverageRating(squad, table) << std::setw(6) << calculateChem(squad, table);
+    }
+    std::cout << std::setprecision(1) << std::setw(10) << peakMemoryMiB() << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <players.csv> <cases.jsonl>... [--repeat N] [--algorithm astar|bestfit|local|idastar|both|all]\n"
+                  << "       " << argv[0] << " <players.csv> --generate N [--seed S]\n";
+        return 1;
+    }
+
+    std::string csvPath = argv[1];
+    std::vector<std::string> casePaths;
+    int repeat = 5;
+    int generate = -1;
+    unsigned seed = 1;
+    std::string algorithm = "both";
+    VersionPolicy versionPolicy = VERSIONS_ALL;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) repeat = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--generate" && i + 1 < argc) generate = std::atoi(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--algorithm" && i + 1 < argc) algorithm = argv[++i];
+        else if (arg == "--versions" && i + 1 < argc) {
+            if (!ParseVersionPolicy(argv[++i], versionPolicy)) {
+                std::cerr << "Unknown version policy " << argv[i] << "\n";
+                return 1;
+            }
+        }
+        else casePaths.push_back(arg);
+    }
+    bool runAStar = algorithm == "astar" || algorithm == "both" || algorithm == "all";
+    bool runBestFit = algorithm == "bestfit" || algorithm == "both" || algorithm == "all";
+    bool runLocal = algorithm == "local" || algorithm == "all";
+    bool runIDAStar = algorithm == "idastar" || algorithm == "all";
+    if (!runAStar && !runBestFit && !runLocal && !runIDAStar) {
+        std::cerr << "Unknown algorithm " << algorithm << "\n";
+        return 1;
+    }
+
+    // Cold load parses the CSV or maps the snapshot if one is already there; the warm load always maps the snapshot
+    PlayerTable loaded;
+    BenchClock::time_point loadStart = BenchClock::now();
+    if (!LoadPlayers(csvPath, loaded, versionPolicy)) return 1;
+    double coldLoad = millisecondsSince(loadStart);
+    loadStart = BenchClock::now();
+    if (!LoadPlayers(csvPath, loaded, versionPolicy)) return 1;
+    double warmLoad = millisecondsSince(loadStart);
+
+    PlayerOrganizer organizer(std::move(loaded));
+    const PlayerTable& table = organizer.GetAllPlayers();
+
+    if (generate >= 0) {
+        generateCases(table, generate, seed);
+        return 0;
+    }
+
+    std::vector<BenchCase> cases;
+    for (const std::string& path : casePaths) {
+        if (!readCases(path, cases)) return 1;
+    }
+
+    std::cout << "players: " << table.Size() << " (versions: " << VersionPolicyName(versionPolicy) << ") | load cold: " << std::fixed << std::setprecision(3) << coldLoad
+              << " ms | load warm: " << warmLoad << " ms | warm runs per case: " << repeat << "\n\n";
+    std::cout << std::left << std::setw(22) << "case" << std::setw(9) << "algo" << std::right << std::setw(11)
+              << "cold ms" << std::setw(11) << "median ms" << std::setw(11) << "p95 ms" << std::setw(12) << "nodes"
+              << std::setw(10) << "cost" << std::setw(8) << "rating" << std::setw(6) << "chem" << std::setw(10)
+              << "peak MiB" << "\n";
+
+    const char* algorithmNames[4] = {"A*", "BestFit", "BF+SA", "IDA*"};
+    std::vector<double> allMedians[4];
+    for (const BenchCase& benchCase : cases) {
+        const SquadRequirements& req = benchCase.req;
+        const Formation& formation = *FindFormation(req.formation); // Checked when the case was read
+
+        for (int algo = 0; algo < 4; algo++) {
+            if ((algo == 0 && !runAStar) || (algo == 1 && !runBestFit) || (algo == 2 && !runLocal) || (algo == 3 && !runIDAStar)) continue;
+            auto solve = [&](const PlayerByPosition& playerByPosition, SearchStats* stats) {
+                if (algo == 0) return AStarSquadOptimizer(formation, table, playerByPosition, req, stats);
+                if (algo == 3) return IDAStarSquadOptimizer(formation, table, playerByPosition, req, stats);
+                std::vector<int> squad = BestFitSquadOptimizer(formation, table, playerByPosition, req, stats);
+                return algo == 1 ? squad : ImproveSquad(formation, table, playerByPosition, req, squad);
+            };
+
+            SearchStats stats;
+            BenchClock::time_point start = BenchClock::now();
+            PlayerByPosition playerByPosition = BuildPlayerByPosition(organizer, formation, req.minOverallRating);
+            ParetoFilterPositions(playerByPosition, formation, table, req);
+            std::vector<int> squad = solve(playerByPosition, &stats);
+            double cold = millisecondsSince(start);
+
+            std::vector<double> warm;
+            for (int run = 0; run < repeat; run++) {
+                start = BenchClock::now();
+                solve(playerByPosition, nullptr);
+                warm.push_back(millisecondsSince(start));
+            }
+
+            double median = percentile(warm, 50);
+            allMedians[algo].push_back(median);
+            printRow(benchCase.id, algorithmNames[algo], cold, median, percentile(warm, 95),
+                     stats.nodesExpanded, squad, table);
+        }
+    }
+
+    std::cout << "\n";
+    for (int algo = 0; algo < 4; algo++) {
+        if (allMedians[algo].empty()) continue;
+        double total = 0;
+        for (double ms : allMedians[algo]) total += ms;
+        std::cout << algorithmNames[algo] << ": " << allMedians[algo].size() << " cases, sum of medians "
+                  << std::setprecision(3) << total << " ms, median of medians " << percentile(allMedians[algo], 50)
+                  << " ms, p95 of medians " << percentile(allMedians[algo], 95) << " ms\n";
+    }
+    std::cout << "peak memory: " << std::setprecision(1) << peakMemoryMiB() << " MiB\n";
+    return 0;
+}
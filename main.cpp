@@ -1,110 +1,155 @@
 #include <iostream>
 #include "Player_Organizer.h"
+#include "PlayerTable.h"
+#include "Snapshot.h"
 #include "Formations.h"
 #include "Requirements.h"
 #include <SquadOptimizer.h>
+#include "ParallelSquadOptimizer.h"
+#include "AnytimeSquadOptimizer.h"
+#include "IDAStarSquadOptimizer.h"
+#include "BatchSolver.h"
+#include "LocalSearch.h"
+#include "ParetoFilter.h"
+#include "ResultCache.h"
+#include "MultiSquadSolver.h"
 #include <fstream>
-#include <sstream>
 #include <vector>
 #include <string>
 #include <unordered_map>
 #include <chrono>
+#include <cstdlib>
+#include <memory>
 
-//Helper which splits each line of the CSV file respecting fields with quotes
-std::vector<std::string> parseCSVLine(const std::string& line){
-    std::vector<std::string> cells;
-    std::string cell;
-    bool inQuotes = false;
-
-    for(int i = 0; i<line.size(); i++){
-        char c = line[i];
-        if(c == '"'){
-            inQuotes = !inQuotes;
-        } else if (c==',' && !inQuotes){
-            cells.push_back(cell);
-            cell.clear();
-        }else{
-            cell += c;
+int main(int argc, char* argv[]) {
+    // --threads N runs A* on N threads (0 = one per core). Without it A* runs on a single thread.
+    // --batch FILE solves every JSON Lines record in FILE (- for stdin) without prompting, see README.
+    // In batch mode --threads sets the number of requests solved at once instead (default one per core).
+    // --versions all|latest|cheapest|best picks which fifa_version rows of each footballer are loaded.
+    // --time-limit SECONDS / --node-limit N make A* return the best squad found within that budget (anytime mode).
+    // --local-search runs simulated annealing on the Best Fit squad, --restarts N / --iterations N tune it.
+    // --low-memory runs A* as IDA*, which keeps memory fixed on hard requests (the time and node limits are then ignored).
+    // --cache FILE keeps solved requests in FILE and answers repeats from it (batch mode always caches in memory).
+    // --joint (batch mode) solves all the records together so no footballer is used in two squads, and
+    // --inventory FILE limits them to the owned footballers listed in FILE (player_id or name per line).
+    // --filter-load only loads the players the requests can use: rated at least the lowest rating floor and playing a
+    // position of one of the formations. Batch mode needs a FILE for it, since the records are read once up front.
+    int threads = 1;
+    bool threadsGiven = false;
+    std::string batchPath;
+    std::string playersPath = "male_players.csv";
+    std::string cachePath;
+    std::string algorithm = "astar";
+    VersionPolicy versionPolicy = VERSIONS_ALL;
+    AnytimeOptions anytime;
+    LocalSearchOptions localSearch;
+    bool useLocalSearch = false;
+    bool lowMemory = false;
+    bool filterLoad = false;
+    bool joint = false;
+    std::string inventoryPath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+            threadsGiven = true;
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batchPath = argv[++i];
+        } else if (arg == "--versions" && i + 1 < argc && ParseVersionPolicy(argv[i + 1], versionPolicy)) {
+            i++;
+        } else if (arg == "--time-limit" && i + 1 < argc) {
+            anytime.timeLimitSeconds = std::atof(argv[++i]);
+        } else if (arg == "--node-limit" && i + 1 < argc) {
+            anytime.nodeLimit = std::atoll(argv[++i]);
+        } else if (arg == "--restarts" && i + 1 < argc) {
+            localSearch.restarts = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            localSearch.iterations = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--low-memory") {
+            lowMemory = true;
+        } else if (arg == "--joint") {
+            joint = true;
+        } else if (arg == "--inventory" && i + 1 < argc) {
+            inventoryPath = argv[++i];
+        } else if (arg == "--filter-load") {
+            filterLoad = true;
+        } else if (arg == "--local-search") {
+            useLocalSearch = true;
+        } else if (arg == "--cache" && i + 1 < argc) {
+            cachePath = argv[++i];
+        } else if (arg == "--players" && i + 1 < argc) {
+            playersPath = argv[++i];
+        } else if (arg == "--algorithm" && i + 1 < argc && (std::string(argv[i + 1]) == "astar" || std::string(argv[i + 1]) == "bestfit")) {
+            algorithm = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--threads N] [--versions all|latest|cheapest|best] [--time-limit SECONDS] [--node-limit N]"
+                      << " [--local-search] [--restarts N] [--iterations N] [--cache FILE] [--low-memory] [--filter-load]\n"
+                      << "       " << argv[0] << " --batch FILE|- [--players male_players.csv] [--algorithm astar|bestfit] [--threads N]"
+                      << " [--versions all|latest|cheapest|best] [--time-limit SECONDS] [--node-limit N]"
+                      << " [--local-search] [--restarts N] [--iterations N] [--cache FILE] [--low-memory] [--filter-load]\n"
+                      << "       " << argv[0] << " --batch FILE|- --joint [--inventory FILE] [--players male_players.csv] [--threads N]"
+                      << " [--time-limit SECONDS] [--node-limit N]"
+                      << " [--versions all|latest|cheapest|best] [--filter-load]\n";
+            return 1;
         }
     }
-    cells.push_back(cell);
-    return cells;
-}
-
-//Helper for splitting the position field (Ex: "ST, LW") into a vector
-std::vector<std::string> splitPositions(const std::string& str){
-    std::vector<std::string> positions;
-    std::stringstream ss(str);
-    std::string pos;
 
-    while(std::getline(ss,pos, ',')){
-        pos.erase(0, pos.find_first_not_of(" \t"));
-        pos.erase(pos.find_last_not_of(" \t") + 1);
-        positions.push_back(pos);
-    }
-    return positions;
-}
+    if (!batchPath.empty()) {
+        std::ifstream batchFile;
+        if (batchPath != "-") {
+            batchFile.open(batchPath);
+            if (!batchFile.is_open()) {
+                std::cerr << "Error opening " << batchPath << "\n";
+                return 1;
+            }
+        }
 
-//Function that reads the csv file and creates all Player objects. Each player is then added to the vector containing all players and another vector that contains all versions of each specific player
-void readData(
-    const std::string& filename,
-    std::vector<Player>& allPlayers,
-    std::unordered_map<std::string,
-    std::vector<Player>>& playersByName)
-{
-    std::ifstream file(filename);
-    if(!file.is_open()){
-        std::cerr <<"Error opening file. \n";
-        return;
-    }
+        // The filter has to keep every player any record can use, so it is built from all of them before loading.
+        // Records that do not parse are skipped here and reported when the batch runs.
+        LoadFilter filter;
+        if (filterLoad && batchPath == "-") {
+            std::cerr << "Warning: --filter-load needs a batch file, loading every player\n";
+        } else if (filterLoad) {
+            std::string line, id, error;
+            SquadRequirements req;
+            while (std::getline(batchFile, line)) {
+                if (ParseRequirementsJSON(line, req, id, error)) filter.Include(*FindFormation(req.formation), req.minOverallRating);
+            }
+            batchFile.clear();
+            batchFile.seekg(0);
+        }
 
-    std::string line;
-    std::getline(file,line); //Header: includes all column names
-    std::vector<std::string> headers = parseCSVLine(line);
+        PlayerTable loaded;
+        if (!LoadPlayers(playersPath, loaded, versionPolicy, filter)) return 1;
+        PlayerOrganizer organizer(std::move(loaded));
 
-    //Maps column names to an index
-    std::unordered_map<std::string, int> columnIndex;
-    for (int i = 0; i < headers.size(); i++) {
-        columnIndex[headers[i]] = i;
-    }
+        if (joint) {
+            IdentitySet inventory;
+            if (!inventoryPath.empty() && !LoadInventory(inventoryPath, organizer.GetAllPlayers(), inventory)) {
+                std::cerr << "Error opening " << inventoryPath << "\n";
+                return 1;
+            }
+            MultiSquadOptions jointOptions;
+            jointOptions.timeLimitSeconds = anytime.timeLimitSeconds;
+            jointOptions.maxNodes = static_cast<size_t>(std::max(0LL, anytime.nodeLimit));
+            unsigned jointThreads = threadsGiven ? static_cast<unsigned>(std::max(0, threads)) : 0;
+            int failed = SolveJointBatch(batchPath == "-" ? std::cin : batchFile, std::cout, organizer,
+                                         inventoryPath.empty() ? nullptr : &inventory, jointThreads, jointOptions);
+            return failed == 0 ? 0 : 1;
+        }
 
-    //Main loop that goes through each line and creates each player object to append to the vector containing all Players
-    while(std::getline(file,line)){
-        std::vector<std::string> cells = parseCSVLine(line);
-        if(cells.size() < headers.size()) continue; //skips any bad rows just in case
-
-        try{
-            std::string name = cells[columnIndex["short_name"]];
-            std::vector<std::string> positions = splitPositions(cells[columnIndex["player_positions"]]);
-
-            int rating = 0;
-            std::string ratingStr = cells[columnIndex["overall"]];
-            if(!ratingStr.empty()) rating = std::stoi(ratingStr);
-
-            int value = 0;
-            std::string valueStr = cells[columnIndex["value_eur"]];
-            if(!valueStr.empty()) value = std::stoi(valueStr);
-            value = value/500;
-
-            std::string nation = cells[columnIndex["nationality_name"]];
-            std::string league = cells[columnIndex["league_name"]];
-            std::string team = cells[columnIndex["club_name"]];
-            //std::string version = cells[columnIndex["fifa_version"]];
-
-            Player player(name,positions,rating,value,nation,league,team);
-            allPlayers.push_back(player);
-            playersByName[name].push_back(player);
-        } catch (...){
-            continue; //Skips bad rows
+        BatchSolver solver(organizer, algorithm == "astar", threadsGiven ? static_cast<unsigned>(std::max(0, threads)) : 0, std::cout, cachePath);
+        if (lowMemory) {
+            solver.SetLowMemory();
+        } else if (anytime.timeLimitSeconds > 0 || anytime.nodeLimit > 0) {
+            solver.SetAnytime(anytime);
         }
+        if (useLocalSearch) solver.SetLocalSearch(localSearch);
+        int failed = solver.Run(batchPath == "-" ? std::cin : batchFile);
+        return failed == 0 ? 0 : 1;
     }
-}
-
 
-
-int main() {
-    std::vector<Player> allPlayers;
-    std::unordered_map<std::string,std::vector<Player>> playersByName;
+    PlayerTable loaded;
 
     std::string file ="male_players.csv";
     char c;
@@ -121,30 +166,23 @@ int main() {
         std::getline(std::cin, file);
     }
 
+    //Prompt user for requirements. They are asked for before loading so --filter-load can skip the players they rule out.
+    SquadRequirements req = Requirements();
+    const Formation& formation = *FindFormation(req.formation); // Requirements() only accepts known formations
+    LoadFilter filter;
+    if (filterLoad) filter.Include(formation, req.minOverallRating);
+
     //file = "C:/Users/lucas/OneDrive/Desktop/male_players.csv";
     //Change the file to your own absolute path if you want to use this program. Change this path before submitting
-    readData(file, allPlayers, playersByName);
+    LoadPlayers(file, loaded, versionPolicy, filter); //Maps male_players.csv.snap when it is up to date, otherwise parses the csv and rebuilds it
+    PlayerOrganizer organizer(std::move(loaded)); //Indexes the players by nation, league, club, position, rating and value
+    const PlayerTable& table = organizer.GetAllPlayers();
+    std::unique_ptr<ResultCache> results;
+    if (!cachePath.empty()) results.reset(new ResultCache(table, 4096, cachePath));
 
-    //Prompt user for requirements
-    SquadRequirements req = Requirements();
-    Formations formations;
-    std::vector<std::string> formation = formations.getPositions(req.formation);
-
-    // Build position-based map. This makes A* much more efficient so that the program only loops through valid players for each position rather than all players.
-    std::unordered_map<std::string, std::vector<Player>> playerByPosition;
-    for (const Player& p : allPlayers) {
-        if (p.rating >= req.minOverallRating) {
-            for (const std::string& pos : p.positions) {
-                playerByPosition[pos].push_back(p);
-            }
-        }
-    }
-
-    for (auto& [pos, vec] : playerByPosition) {
-        std::sort(vec.begin(), vec.end(), [](const Player& a, const Player& b) {
-            return a.value > b.value;
-        });
-    }
+    // Only players who play a position in the formation and meet the rating floor are searched
+    PlayerByPosition playerByPosition = BuildPlayerByPosition(organizer, formation, req.minOverallRating);
+    ParetoFilterPositions(playerByPosition, formation, table, req); //Drops players who can always be swapped for a cheaper, better one
 
     std::string choice;
     std::cout<<"Choose which algorithm to use by typing 1,2, or 3:\n";
@@ -154,9 +192,50 @@ int main() {
     std::cin>>choice;
 
 
-    if(choice == "1" || choice == "3") {
+    if((choice == "1" || choice == "3") && !lowMemory && (anytime.timeLimitSeconds > 0 || anytime.nodeLimit > 0)) {
+        // Anytime mode: report every better squad as it is found, then the best one with its optimality bound
+        anytime.onImprove = [&](const AnytimeResult& progress) {
+            std::cout << "Found squad with value " << progress.cost << " after " << progress.seconds
+                      << " seconds (at most " << progress.Gap() * 100 << "% above optimal)\n";
+        };
+        SearchStats stats;
+        AnytimeResult result = AnytimeSquadOptimizer(formation, table, playerByPosition, req, anytime, &stats);
+
+        if (result.squad.empty()) {
+            std::cout << "\nNo valid squad could be generated " << (result.exhausted ? "with the given constraints.\n" : "within the limit.\n");
+        } else {
+            std::cout << "\n--- A* Squad---\n";
+            for (int p : result.squad) {
+                std::cout << table.GetName(p) << " | Rating: " << table.ratings[p] << " | Value: " << table.values[p]  << "\n";
+            }
+            std::cout << "Total Chemistry: " << calculateChem(result.squad, table) << "\n";
+            std::cout << "Total Value: " << result.cost << "\n";
+            std::cout << "Rating: " << calculateAverageRating(result.squad, table) << "\n";
+            if (result.optimal) {
+                std::cout << "This squad is optimal.\n";
+            } else {
+                std::cout << "Lower bound: " << result.lowerBound << " (at most " << result.Gap() * 100 << "% above optimal)\n";
+            }
+            std::cout << "A* runtime: " << result.seconds << " seconds\n";
+        }
+#ifdef SQUAD_PROFILE
+        std::cout << "Search stats: " << stats.ToJSON() << "\n";
+#endif
+    } else if(choice == "1" || choice == "3") {
         auto start = std::chrono::system_clock::now();
-        std::vector<Player> bestSquad = AStarSquadOptimizer(formation, playerByPosition, req);
+        std::vector<int> bestSquad;
+        SearchStats stats;
+        bool searched = !results || !results->Get("astar", req, bestSquad);
+        if (searched) {
+            if (lowMemory) {
+                bestSquad = IDAStarSquadOptimizer(formation, table, playerByPosition, req, &stats);
+            } else {
+                bestSquad = threads == 1
+                    ? AStarSquadOptimizer(formation, table, playerByPosition, req, &stats)
+                    : ParallelAStarSquadOptimizer(formation, table, playerByPosition, req, threads, &stats);
+            }
+            if (results) results->Put("astar", req, bestSquad);
+        }
         auto end = std::chrono::system_clock::now();
         std::chrono::duration<double> duration = end - start;
 
@@ -164,20 +243,34 @@ int main() {
             std::cout << "\nNo valid squad could be generated with the given constraints.\n";
         } else {
             std::cout << "\n--- A* Squad---\n";
-            for (const Player& p : bestSquad) {
-                std::cout << p.name << " | Rating: " << p.rating << " | Value: " << p.value  << "\n";
+            for (int p : bestSquad) {
+                std::cout << table.GetName(p) << " | Rating: " << table.ratings[p] << " | Value: " << table.values[p]  << "\n";
             }
-            std::cout << "Total Chemistry: " << calculateChem(bestSquad) << "\n";
-            std::cout << "Total Value: " << calculateTotalSquadValue(bestSquad) << "\n";
-            std::cout << "Rating: " << calculateAverageRating(bestSquad) << "\n";
+            std::cout << "Total Chemistry: " << calculateChem(bestSquad, table) << "\n";
+            std::cout << "Total Value: " << calculateTotalSquadValue(bestSquad, table) << "\n";
+            std::cout << "Rating: " << calculateAverageRating(bestSquad, table) << "\n";
             std::cout << "A* runtime: " << duration.count() << " seconds\n";
         }
+#ifdef SQUAD_PROFILE
+        if (searched) std::cout << "Search stats: " << stats.ToJSON() << "\n";
+#endif
     }
 
     //Run A* function to find the best squad given the requirements
     if(choice == "2" || choice == "3") {
         auto start = std::chrono::system_clock::now();
-        std::vector<Player> bestSquad = BestFitSquadOptimizer(formation, playerByPosition, req);
+        std::string label = SolverLabel(false, useLocalSearch, localSearch);
+        std::vector<int> bestSquad;
+        SearchStats stats;
+        bool searched = !results || !results->Get(label, req, bestSquad);
+        if (searched) {
+            bestSquad = BestFitSquadOptimizer(formation, table, playerByPosition, req, &stats);
+            if (useLocalSearch) {
+                // Anneal from the greedy squad (or from random squads if Best Fit found none)
+                bestSquad = ImproveSquad(formation, table, playerByPosition, req, bestSquad, localSearch);
+            }
+            if (results) results->Put(label, req, bestSquad);
+        }
         auto end = std::chrono::system_clock::now();
         std::chrono::duration<double> duration = end - start;
 
@@ -185,14 +278,17 @@ int main() {
             std::cout << "\nNo valid squad could be generated with the given constraints.\n";
         } else {
             std::cout << "\n--- Best Fit Squad---\n";
-            for (const Player& p : bestSquad) {
-                std::cout << p.name << " | Rating: " << p.rating << " | Value: " << p.value << "\n";
+            for (int p : bestSquad) {
+                std::cout << table.GetName(p) << " | Rating: " << table.ratings[p] << " | Value: " << table.values[p] << "\n";
             }
-            std::cout << "Total Chemistry: " << calculateChem(bestSquad) << "\n";
-            std::cout << "Total Value: " << calculateTotalSquadValue(bestSquad) << "\n";
-            std::cout << "Rating: " << calculateAverageRating(bestSquad) << "\n";
+            std::cout << "Total Chemistry: " << calculateChem(bestSquad, table) << "\n";
+            std::cout << "Total Value: " << calculateTotalSquadValue(bestSquad, table) << "\n";
+            std::cout << "Rating: " << calculateAverageRating(bestSquad, table) << "\n";
             std::cout << "Best Fit runtime: " << duration.count() << " seconds\n";
         }
+#ifdef SQUAD_PROFILE
+        if (searched) std::cout << "Search stats: " << stats.ToJSON() << "\n";
+#endif
     }
 
     return 0;